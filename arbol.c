@@ -0,0 +1,395 @@
+#include "arbol.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Grado mínimo del árbol: cada nodo salvo la raíz tiene entre GRADO - 1 y
+ * 2 * GRADO - 1 elementos */
+#define GRADO 16
+#define MAX_ELEMENTOS (2 * GRADO - 1)
+#define PROFUNDIDAD_MAXIMA 32
+
+/* Las hojas son sólo un nodo_arbol_t; los nodos internos, un nodo_interno_t
+ * que agrega el arreglo de hijos, al que se accede con hijos_nodo. */
+typedef struct nodo_arbol {
+    size_t cant;
+    bool hoja;
+    void* datos[MAX_ELEMENTOS];
+} nodo_arbol_t;
+
+typedef struct nodo_interno {
+    nodo_arbol_t nodo;
+    nodo_arbol_t* hijos[MAX_ELEMENTOS + 1];
+} nodo_interno_t;
+
+struct arbol {
+    nodo_arbol_t* raiz;
+    size_t cantidad;
+    arbol_comparar_t comparar;
+    void* extra;
+};
+
+/* El iterador guarda el camino desde la raíz: en cada nivel, el nodo y la
+ * posición del próximo elemento a visitar en él. El elemento actual es el
+ * del último nivel. */
+struct arbol_iter {
+    const nodo_arbol_t* nodos[PROFUNDIDAD_MAXIMA];
+    size_t posiciones[PROFUNDIDAD_MAXIMA];
+    size_t niveles;
+};
+
+nodo_arbol_t* crear_nodo_arbol(bool hoja){
+    nodo_arbol_t* nodo;
+    if (hoja) nodo = malloc(sizeof(nodo_arbol_t));
+    else{
+        nodo_interno_t* interno = malloc(sizeof(nodo_interno_t));
+        nodo = interno ? &interno->nodo : NULL;
+    }
+    if (!nodo) return NULL;
+    nodo->cant = 0;
+    nodo->hoja = hoja;
+    return nodo;
+}
+
+/* Devuelve el arreglo de hijos de un nodo interno */
+nodo_arbol_t** hijos_nodo(const nodo_arbol_t* nodo){
+    return ((nodo_interno_t*)nodo)->hijos;
+}
+
+void destruir_nodo_arbol(nodo_arbol_t* nodo){
+    for (size_t i = 0; !nodo->hoja && i <= nodo->cant; i++) destruir_nodo_arbol(hijos_nodo(nodo)[i]);
+    free(nodo);
+}
+
+arbol_t *arbol_crear(arbol_comparar_t comparar, void *extra){
+    arbol_t* arbol = malloc(sizeof(arbol_t));
+    if (!arbol) return NULL;
+    arbol->raiz = NULL;
+    arbol->cantidad = 0;
+    arbol->comparar = comparar;
+    arbol->extra = extra;
+    return arbol;
+}
+
+/* Devuelve la posición del primer elemento del nodo que no es menor que
+ * buscado, y en igual si es igual a buscado */
+size_t buscar_en_nodo(const arbol_t* arbol, const nodo_arbol_t* nodo, const void* buscado, bool* igual){
+    size_t ini = 0, fin = nodo->cant;
+    *igual = false;
+    while (ini < fin){
+        size_t medio = (ini + fin) / 2;
+        int comparacion = arbol->comparar(buscado, nodo->datos[medio], arbol->extra);
+        if (!comparacion){
+            *igual = true;
+            return medio;
+        }
+        if (comparacion > 0) ini = medio + 1;
+        else fin = medio;
+    }
+    return ini;
+}
+
+/* Parte el hijo i del padre, que está lleno, subiendo su elemento del medio
+ * al padre, que no está lleno */
+bool partir_hijo(nodo_arbol_t* padre, size_t i){
+    nodo_arbol_t* izq = hijos_nodo(padre)[i];
+    nodo_arbol_t* der = crear_nodo_arbol(izq->hoja);
+    if (!der) return false;
+
+    der->cant = GRADO - 1;
+    memcpy(der->datos, izq->datos + GRADO, (GRADO - 1) * sizeof(void*));
+    if (!izq->hoja) memcpy(hijos_nodo(der), hijos_nodo(izq) + GRADO, GRADO * sizeof(nodo_arbol_t*));
+    izq->cant = GRADO - 1;
+
+    memmove(hijos_nodo(padre) + i + 2, hijos_nodo(padre) + i + 1, (padre->cant - i) * sizeof(nodo_arbol_t*));
+    memmove(padre->datos + i + 1, padre->datos + i, (padre->cant - i) * sizeof(void*));
+    hijos_nodo(padre)[i + 1] = der;
+    padre->datos[i] = izq->datos[GRADO - 1];
+    padre->cant++;
+    return true;
+}
+
+/* Inserta partiendo de antemano los nodos llenos del camino, por lo que si
+ * falla el árbol sigue siendo válido. Si ultimo es verdadero, inserta al
+ * final sin comparar. */
+bool insertar_en_arbol(arbol_t* arbol, void* dato, bool ultimo){
+    if (!arbol->raiz) arbol->raiz = crear_nodo_arbol(true);
+    if (!arbol->raiz) return false;
+    if (arbol->raiz->cant == MAX_ELEMENTOS){
+        nodo_arbol_t* raiz = crear_nodo_arbol(false);
+        if (!raiz) return false;
+        hijos_nodo(raiz)[0] = arbol->raiz;
+        if (!partir_hijo(raiz, 0)){
+            free(raiz);
+            return false;
+        }
+        arbol->raiz = raiz;
+    }
+
+    nodo_arbol_t* nodo = arbol->raiz;
+    bool igual;
+    while (true){
+        size_t i = ultimo ? nodo->cant : buscar_en_nodo(arbol, nodo, dato, &igual);
+        if (nodo->hoja){
+            memmove(nodo->datos + i + 1, nodo->datos + i, (nodo->cant - i) * sizeof(void*));
+            nodo->datos[i] = dato;
+            nodo->cant++;
+            arbol->cantidad++;
+            return true;
+        }
+        if (hijos_nodo(nodo)[i]->cant == MAX_ELEMENTOS){
+            if (!partir_hijo(nodo, i)) return false;
+            if (ultimo || arbol->comparar(dato, nodo->datos[i], arbol->extra) > 0) i++;
+        }
+        nodo = hijos_nodo(nodo)[i];
+    }
+}
+
+bool arbol_insertar(arbol_t *arbol, void *dato){
+    return insertar_en_arbol(arbol, dato, false);
+}
+
+bool arbol_insertar_ultimo(arbol_t *arbol, void *dato){
+    return insertar_en_arbol(arbol, dato, true);
+}
+
+/* Pasa el último elemento del hijo i al hijo i + 1, a través del padre */
+void rotar_derecha(nodo_arbol_t* padre, size_t i){
+    nodo_arbol_t* izq = hijos_nodo(padre)[i];
+    nodo_arbol_t* der = hijos_nodo(padre)[i + 1];
+    memmove(der->datos + 1, der->datos, der->cant * sizeof(void*));
+    der->datos[0] = padre->datos[i];
+    if (!der->hoja){
+        memmove(hijos_nodo(der) + 1, hijos_nodo(der), (der->cant + 1) * sizeof(nodo_arbol_t*));
+        hijos_nodo(der)[0] = hijos_nodo(izq)[izq->cant];
+    }
+    der->cant++;
+    padre->datos[i] = izq->datos[izq->cant - 1];
+    izq->cant--;
+}
+
+/* Pasa el primer elemento del hijo i + 1 al hijo i, a través del padre */
+void rotar_izquierda(nodo_arbol_t* padre, size_t i){
+    nodo_arbol_t* izq = hijos_nodo(padre)[i];
+    nodo_arbol_t* der = hijos_nodo(padre)[i + 1];
+    izq->datos[izq->cant] = padre->datos[i];
+    if (!izq->hoja) hijos_nodo(izq)[izq->cant + 1] = hijos_nodo(der)[0];
+    izq->cant++;
+    padre->datos[i] = der->datos[0];
+    memmove(der->datos, der->datos + 1, (der->cant - 1) * sizeof(void*));
+    if (!der->hoja) memmove(hijos_nodo(der), hijos_nodo(der) + 1, der->cant * sizeof(nodo_arbol_t*));
+    der->cant--;
+}
+
+/* Une los hijos i e i + 1, que tienen GRADO - 1 elementos, con el elemento
+ * i del padre en el medio */
+void unir_hijos(nodo_arbol_t* padre, size_t i){
+    nodo_arbol_t* izq = hijos_nodo(padre)[i];
+    nodo_arbol_t* der = hijos_nodo(padre)[i + 1];
+    izq->datos[izq->cant] = padre->datos[i];
+    memcpy(izq->datos + izq->cant + 1, der->datos, der->cant * sizeof(void*));
+    if (!izq->hoja) memcpy(hijos_nodo(izq) + izq->cant + 1, hijos_nodo(der), (der->cant + 1) * sizeof(nodo_arbol_t*));
+    izq->cant += der->cant + 1;
+    free(der);
+
+    memmove(padre->datos + i, padre->datos + i + 1, (padre->cant - i - 1) * sizeof(void*));
+    memmove(hijos_nodo(padre) + i + 1, hijos_nodo(padre) + i + 2, (padre->cant - i - 1) * sizeof(nodo_arbol_t*));
+    padre->cant--;
+}
+
+/* Se asegura de que el hijo i tenga al menos GRADO elementos antes de bajar
+ * a él, pidiendo uno a un hermano o uniéndolo con uno. Devuelve el nodo al
+ * que hay que bajar. */
+nodo_arbol_t* asegurar_hijo(nodo_arbol_t* nodo, size_t i){
+    nodo_arbol_t* hijo = hijos_nodo(nodo)[i];
+    if (hijo->cant >= GRADO) return hijo;
+    if (i > 0 && hijos_nodo(nodo)[i - 1]->cant >= GRADO){
+        rotar_derecha(nodo, i - 1);
+    }
+    else if (i < nodo->cant && hijos_nodo(nodo)[i + 1]->cant >= GRADO){
+        rotar_izquierda(nodo, i);
+    }
+    else if (i < nodo->cant){
+        unir_hijos(nodo, i);
+    }
+    else{
+        unir_hijos(nodo, i - 1);
+        hijo = hijos_nodo(nodo)[i - 1];
+    }
+    return hijo;
+}
+
+/* Borran el mayor o el menor elemento del subárbol, que tiene al menos
+ * GRADO elementos en la raíz, sin comparar */
+void* borrar_maximo(nodo_arbol_t* nodo){
+    while (!nodo->hoja) nodo = asegurar_hijo(nodo, nodo->cant);
+    return nodo->datos[--nodo->cant];
+}
+
+void* borrar_minimo(nodo_arbol_t* nodo){
+    while (!nodo->hoja) nodo = asegurar_hijo(nodo, 0);
+    void* dato = nodo->datos[0];
+    memmove(nodo->datos, nodo->datos + 1, (--nodo->cant) * sizeof(void*));
+    return dato;
+}
+
+/* Borra bajando una sola vez desde la raíz: antes de bajar a un hijo se
+ * asegura de que tenga elementos de sobra, por lo que borrar nunca pide
+ * memoria. */
+void* borrar_de_arbol(arbol_t* arbol, nodo_arbol_t* nodo, const void* buscado){
+    while (true){
+        bool igual;
+        size_t i = buscar_en_nodo(arbol, nodo, buscado, &igual);
+        if (igual && nodo->hoja){
+            void* dato = nodo->datos[i];
+            memmove(nodo->datos + i, nodo->datos + i + 1, (nodo->cant - i - 1) * sizeof(void*));
+            nodo->cant--;
+            return dato;
+        }
+        if (nodo->hoja) return NULL;
+        if (igual){
+            void* dato = nodo->datos[i];
+            if (hijos_nodo(nodo)[i]->cant >= GRADO){
+                nodo->datos[i] = borrar_maximo(hijos_nodo(nodo)[i]);
+                return dato;
+            }
+            if (hijos_nodo(nodo)[i + 1]->cant >= GRADO){
+                nodo->datos[i] = borrar_minimo(hijos_nodo(nodo)[i + 1]);
+                return dato;
+            }
+            // El elemento baja al hijo unido, y se lo sigue buscando ahí
+            unir_hijos(nodo, i);
+            nodo = hijos_nodo(nodo)[i];
+            continue;
+        }
+        nodo = asegurar_hijo(nodo, i);
+    }
+}
+
+void *arbol_borrar(arbol_t *arbol, const void *buscado){
+    if (!arbol->raiz) return NULL;
+    void* dato = borrar_de_arbol(arbol, arbol->raiz, buscado);
+    if (dato) arbol->cantidad--;
+
+    nodo_arbol_t* raiz = arbol->raiz;
+    if (!raiz->cant){
+        arbol->raiz = raiz->hoja ? NULL : hijos_nodo(raiz)[0];
+        free(raiz);
+    }
+    return dato;
+}
+
+void *arbol_reemplazar(arbol_t *arbol, void *dato){
+    nodo_arbol_t* nodo = arbol->raiz;
+    while (nodo){
+        bool igual;
+        size_t i = buscar_en_nodo(arbol, nodo, dato, &igual);
+        if (igual){
+            void* anterior = nodo->datos[i];
+            nodo->datos[i] = dato;
+            return anterior;
+        }
+        nodo = nodo->hoja ? NULL : hijos_nodo(nodo)[i];
+    }
+    return NULL;
+}
+
+size_t arbol_cantidad(const arbol_t *arbol){
+    return arbol->cantidad;
+}
+
+void arbol_destruir(arbol_t *arbol){
+    if (arbol->raiz) destruir_nodo_arbol(arbol->raiz);
+    free(arbol);
+}
+
+bool arbol_destruir_por_partes(arbol_t *arbol, size_t *presupuesto){
+    while (arbol->raiz){
+        if (!(*presupuesto)--) return false;
+        // Libera la última hoja, bajando por los últimos hijos
+        nodo_arbol_t* padre = NULL;
+        nodo_arbol_t* nodo = arbol->raiz;
+        while (!nodo->hoja){
+            padre = nodo;
+            nodo = hijos_nodo(nodo)[nodo->cant];
+        }
+        free(nodo);
+        // El padre pierde su último hijo; sin hijos queda como una hoja, cuyos
+        // elementos ya no importan
+        if (!padre) arbol->raiz = NULL;
+        else if (padre->cant) padre->cant--;
+        else padre->hoja = true;
+    }
+    free(arbol);
+    return true;
+}
+
+/* Sube por el camino hasta un nivel que tenga un elemento por visitar */
+void subir_camino(arbol_iter_t* iter){
+    while (iter->niveles && iter->posiciones[iter->niveles - 1] >= iter->nodos[iter->niveles - 1]->cant){
+        iter->niveles--;
+    }
+}
+
+/* Baja desde el nodo por los primeros hijos hasta una hoja */
+void bajar_camino(arbol_iter_t* iter, const nodo_arbol_t* nodo){
+    while (true){
+        iter->nodos[iter->niveles] = nodo;
+        iter->posiciones[iter->niveles] = 0;
+        iter->niveles++;
+        if (nodo->hoja) return;
+        nodo = hijos_nodo(nodo)[0];
+    }
+}
+
+arbol_iter_t *arbol_iter_crear(const arbol_t *arbol, const void *desde){
+    arbol_iter_t* iter = malloc(sizeof(arbol_iter_t));
+    if (!iter) return NULL;
+    arbol_iter_reubicar(iter, arbol, desde);
+    return iter;
+}
+
+void arbol_iter_reubicar(arbol_iter_t *iter, const arbol_t *arbol, const void *desde){
+    iter->niveles = 0;
+    if (!arbol->raiz) return;
+    if (!desde){
+        bajar_camino(iter, arbol->raiz);
+        subir_camino(iter);
+        return;
+    }
+
+    const nodo_arbol_t* nodo = arbol->raiz;
+    while (true){
+        bool igual;
+        size_t i = buscar_en_nodo(arbol, nodo, desde, &igual);
+        iter->nodos[iter->niveles] = nodo;
+        iter->posiciones[iter->niveles] = i;
+        iter->niveles++;
+        if (igual || nodo->hoja) break;
+        nodo = hijos_nodo(nodo)[i];
+    }
+    subir_camino(iter);
+}
+
+bool arbol_iter_avanzar(arbol_iter_t *iter){
+    if (arbol_iter_al_final(iter)) return false;
+    size_t nivel = iter->niveles - 1;
+    const nodo_arbol_t* nodo = iter->nodos[nivel];
+    iter->posiciones[nivel]++;
+    if (!nodo->hoja) bajar_camino(iter, hijos_nodo(nodo)[iter->posiciones[nivel]]);
+    subir_camino(iter);
+    return true;
+}
+
+void *arbol_iter_ver_actual(const arbol_iter_t *iter){
+    if (arbol_iter_al_final(iter)) return NULL;
+    return iter->nodos[iter->niveles - 1]->datos[iter->posiciones[iter->niveles - 1]];
+}
+
+bool arbol_iter_al_final(const arbol_iter_t *iter){
+    return !iter->niveles;
+}
+
+void arbol_iter_destruir(arbol_iter_t *iter){
+    free(iter);
+}
@@ -0,0 +1,97 @@
+#ifndef ARBOL_H
+#define ARBOL_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* El árbol es un árbol B de punteros genéricos, ordenados según una función
+ * de comparación. No admite elementos repetidos. */
+
+typedef struct arbol arbol_t;
+typedef struct arbol_iter arbol_iter_t;
+
+// Compara un elemento buscado con uno guardado en el árbol, y devuelve un
+// número negativo, cero o positivo si el buscado es menor, igual o mayor.
+// extra es el parámetro que se pasó a arbol_crear.
+typedef int (*arbol_comparar_t)(const void *buscado, const void *guardado, void *extra);
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ÁRBOL
+ * *****************************************************************/
+
+// Crea un árbol vacío que ordena sus elementos con comparar.
+// Post: devuelve un nuevo árbol vacío, o NULL si no hubo memoria.
+arbol_t *arbol_crear(arbol_comparar_t comparar, void *extra);
+
+// Inserta el elemento en su posición. Devuelve falso si no hubo memoria.
+// Pre: el árbol fue creado y el elemento no está en el árbol.
+bool arbol_insertar(arbol_t *arbol, void *dato);
+
+// Inserta el elemento después de todos los demás, sin compararlo, para
+// construir el árbol a partir de elementos ya ordenados. Devuelve falso si no
+// hubo memoria.
+// Pre: el árbol fue creado y el elemento es mayor que todos los del árbol.
+bool arbol_insertar_ultimo(arbol_t *arbol, void *dato);
+
+// Borra el elemento igual a buscado y lo devuelve, o NULL si no estaba.
+// Pre: el árbol fue creado.
+void *arbol_borrar(arbol_t *arbol, const void *buscado);
+
+// Reemplaza el elemento igual a dato por dato, sin cambiar el orden, y
+// devuelve el anterior, o NULL si no había uno igual.
+// Pre: el árbol fue creado.
+void *arbol_reemplazar(arbol_t *arbol, void *dato);
+
+// Devuelve la cantidad de elementos del árbol.
+// Pre: el árbol fue creado.
+size_t arbol_cantidad(const arbol_t *arbol);
+
+// Destruye el árbol, sin destruir sus elementos.
+// Pre: el árbol fue creado.
+void arbol_destruir(arbol_t *arbol);
+
+// Destruye el árbol como arbol_destruir, pero de a partes: libera a lo sumo
+// *presupuesto nodos, descontándolos de *presupuesto, y devuelve true cuando
+// terminó de destruirlo. Entre llamadas, el árbol sólo puede usarse para
+// seguir destruyéndolo.
+// Pre: el árbol fue creado.
+// Post: si devolvió true, el árbol fue destruido.
+bool arbol_destruir_por_partes(arbol_t *arbol, size_t *presupuesto);
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DEL ITERADOR
+ * *****************************************************************/
+
+// Crea un iterador que recorre los elementos en orden, empezando por el
+// primero que no es menor que desde, o por el primero del árbol si desde es
+// NULL. El iterador deja de ser válido si se modifica el árbol.
+// Pre: el árbol fue creado.
+// Post: devuelve el iterador, o NULL si no hubo memoria.
+arbol_iter_t *arbol_iter_crear(const arbol_t *arbol, const void *desde);
+
+// Vuelve a ubicar el iterador en el primer elemento que no es menor que
+// desde, o en el primero del árbol si desde es NULL. Permite seguir usando un
+// iterador después de modificar el árbol.
+// Pre: el iterador fue creado sobre el árbol.
+void arbol_iter_reubicar(arbol_iter_t *iter, const arbol_t *arbol, const void *desde);
+
+// Avanza al siguiente elemento. Devuelve falso si ya estaba al final.
+bool arbol_iter_avanzar(arbol_iter_t *iter);
+
+// Devuelve el elemento actual, o NULL si está al final.
+void *arbol_iter_ver_actual(const arbol_iter_t *iter);
+
+// Devuelve verdadero si ya se recorrieron todos los elementos.
+bool arbol_iter_al_final(const arbol_iter_t *iter);
+
+// Destruye el iterador.
+void arbol_iter_destruir(arbol_iter_t *iter);
+
+#endif // ARBOL_H
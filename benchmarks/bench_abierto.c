@@ -0,0 +1,106 @@
+/* Compara hash_t con hash_abierto_t: inserción, búsquedas que aciertan,
+ * búsquedas que fallan, y las mismas búsquedas con la tabla abierta cerca
+ * de su carga máxima.
+ *
+ *   gcc -O2 -std=gnu99 -I. -pthread -o bench_abierto benchmarks/bench_abierto.c \
+ *       hash.c hash_abierto.c hash_internador.c lista.c arbol.c memoria.c
+ *   ./bench_abierto [cantidad]
+ */
+
+#include "hash.h"
+#include "hash_abierto.h"
+#include "benchmarks/medir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CONSULTAS 4000000
+#define LARGO_CLAVE 24
+
+typedef struct tiempos {
+    double insertar;
+    double aciertos;
+    double fallos;
+} tiempos_t;
+
+static tiempos_t medir_hash(char (*claves)[LARGO_CLAVE], char (*fallos)[LARGO_CLAVE], const size_t *orden, size_t n, size_t *encontradas)
+{
+    tiempos_t tiempos;
+    hash_t* hash = hash_crear(NULL);
+
+    double t = ahora();
+    for (size_t i = 0; i < n; i++) hash_guardar(hash, claves[i], claves[i]);
+    tiempos.insertar = (ahora() - t) / (double)n;
+
+    t = ahora();
+    for (size_t q = 0; q < CONSULTAS; q++) *encontradas += hash_obtener(hash, claves[orden[q]]) != NULL;
+    tiempos.aciertos = (ahora() - t) / CONSULTAS;
+
+    t = ahora();
+    for (size_t q = 0; q < CONSULTAS; q++) *encontradas += hash_obtener(hash, fallos[orden[q]]) != NULL;
+    tiempos.fallos = (ahora() - t) / CONSULTAS;
+
+    hash_destruir(hash);
+    return tiempos;
+}
+
+static tiempos_t medir_abierto(char (*claves)[LARGO_CLAVE], char (*fallos)[LARGO_CLAVE], const size_t *orden, size_t n, size_t *encontradas)
+{
+    tiempos_t tiempos;
+    hash_abierto_t* hash = hash_abierto_crear(NULL);
+
+    double t = ahora();
+    for (size_t i = 0; i < n; i++) hash_abierto_guardar(hash, claves[i], claves[i]);
+    tiempos.insertar = (ahora() - t) / (double)n;
+
+    t = ahora();
+    for (size_t q = 0; q < CONSULTAS; q++) *encontradas += hash_abierto_obtener(hash, claves[orden[q]]) != NULL;
+    tiempos.aciertos = (ahora() - t) / CONSULTAS;
+
+    t = ahora();
+    for (size_t q = 0; q < CONSULTAS; q++) *encontradas += hash_abierto_obtener(hash, fallos[orden[q]]) != NULL;
+    tiempos.fallos = (ahora() - t) / CONSULTAS;
+
+    hash_abierto_destruir(hash);
+    return tiempos;
+}
+
+static void imprimir(const char *nombre, size_t n, tiempos_t tiempos)
+{
+    printf("%-9s n=%-9zu insertar %6.1f ns | acierto %6.1f ns | fallo %6.1f ns\n", nombre, n,
+           tiempos.insertar * 1e9, tiempos.aciertos * 1e9, tiempos.fallos * 1e9);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t maximo = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    char (*claves)[LARGO_CLAVE] = malloc(maximo * LARGO_CLAVE);
+    char (*fallos)[LARGO_CLAVE] = malloc(maximo * LARGO_CLAVE);
+    size_t* orden = malloc(CONSULTAS * sizeof(size_t));
+    if (!claves || !fallos || !orden) return 1;
+    for (size_t i = 0; i < maximo; i++) {
+        sprintf(claves[i], "usuario:%zu", i * 7919);
+        sprintf(fallos[i], "usuario:%zu", i * 7919 + 1);
+    }
+
+    /* hash_abierto_t duplica su capacidad, potencia de 2, al llegar a 7/8
+     * de carga: con n potencia de 2 queda a media carga, y con n * 7/8 - 1
+     * justo debajo de la carga máxima */
+    size_t encontradas = 0;
+    for (size_t n = 1024; n <= maximo; n *= 8) {
+        size_t cargas[] = {n, n / 8 * 7 - 1};
+        for (size_t c = 0; c < 2; c++) {
+            srand(1);
+            for (size_t q = 0; q < CONSULTAS; q++) orden[q] = ((size_t)rand() * 31u + (size_t)rand()) % cargas[c];
+            printf("%s\n", c ? "carga alta:" : "carga baja:");
+            imprimir("hash_t", cargas[c], medir_hash(claves, fallos, orden, cargas[c], &encontradas));
+            imprimir("abierto", cargas[c], medir_abierto(claves, fallos, orden, cargas[c], &encontradas));
+        }
+    }
+    printf("(%zu)\n", encontradas);
+
+    free(claves);
+    free(fallos);
+    free(orden);
+    return 0;
+}
@@ -0,0 +1,106 @@
+/* Mide el caudal de cola_concurrente_t contra una lista protegida por un
+ * mutex, con 1, 2 y 4 productores y consumidores.
+ *
+ *   gcc -O2 -std=gnu99 -I. -pthread -o bench_cola benchmarks/bench_cola.c \
+ *       cola_concurrente.c lista.c
+ *   ./bench_cola [elementos]
+ */
+
+#include "cola_concurrente.h"
+#include "lista.h"
+#include "benchmarks/medir.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CAPACIDAD_COLA 1024
+#define MAX_HILOS 4
+
+/* Lo que comparten los hilos de una medición: la cola concurrente, o la
+ * lista con su mutex */
+typedef struct prueba {
+    cola_concurrente_t* cola;
+    lista_t* lista;
+    pthread_mutex_t mutex;
+    size_t por_productor;
+    size_t por_consumidor;
+} prueba_t;
+
+static void *producir(void *extra)
+{
+    prueba_t* prueba = extra;
+    for (size_t i = 1; i <= prueba->por_productor; i++) {
+        void* dato = (void*)(uintptr_t)i;
+        if (prueba->cola) {
+            while (!cola_concurrente_encolar(prueba->cola, dato)) sched_yield();
+            continue;
+        }
+        pthread_mutex_lock(&prueba->mutex);
+        lista_insertar_ultimo(prueba->lista, dato);
+        pthread_mutex_unlock(&prueba->mutex);
+    }
+    return NULL;
+}
+
+static void *consumir(void *extra)
+{
+    prueba_t* prueba = extra;
+    for (size_t i = 0; i < prueba->por_consumidor; i++) {
+        void* dato = NULL;
+        if (prueba->cola) {
+            while (!cola_concurrente_desencolar(prueba->cola, &dato)) sched_yield();
+            continue;
+        }
+        while (true) {
+            pthread_mutex_lock(&prueba->mutex);
+            dato = lista_borrar_primero(prueba->lista);
+            pthread_mutex_unlock(&prueba->mutex);
+            if (dato) break;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/* Devuelve millones de elementos por segundo que pasaron por la cola */
+static double medir(bool concurrente, size_t productores, size_t consumidores, size_t total)
+{
+    prueba_t prueba;
+    prueba.cola = concurrente ? cola_concurrente_crear(CAPACIDAD_COLA) : NULL;
+    prueba.lista = concurrente ? NULL : lista_crear();
+    pthread_mutex_init(&prueba.mutex, NULL);
+    prueba.por_productor = total / productores;
+    prueba.por_consumidor = prueba.por_productor * productores / consumidores;
+
+    pthread_t hilos[2 * MAX_HILOS];
+    double t = ahora();
+    for (size_t i = 0; i < productores; i++) pthread_create(&hilos[i], NULL, producir, &prueba);
+    for (size_t i = 0; i < consumidores; i++) pthread_create(&hilos[productores + i], NULL, consumir, &prueba);
+    for (size_t i = 0; i < productores + consumidores; i++) pthread_join(hilos[i], NULL);
+    t = ahora() - t;
+
+    if (prueba.cola) cola_concurrente_destruir(prueba.cola, NULL);
+    if (prueba.lista) lista_destruir(prueba.lista, NULL);
+    pthread_mutex_destroy(&prueba.mutex);
+    return (double)(prueba.por_productor * productores) / t / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t total = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+
+    /* Con 1, 2 y 4 hilos el total se reparte sin resto entre productores y
+     * consumidores si es múltiplo de 4 */
+    total -= total % MAX_HILOS;
+    for (size_t productores = 1; productores <= MAX_HILOS; productores *= 2) {
+        for (size_t consumidores = 1; consumidores <= MAX_HILOS; consumidores *= 2) {
+            printf("productores=%zu consumidores=%zu: cola %6.1f Mops/s | mutex+lista %6.1f Mops/s\n",
+                   productores, consumidores, medir(true, productores, consumidores, total),
+                   medir(false, productores, consumidores, total));
+        }
+    }
+    return 0;
+}
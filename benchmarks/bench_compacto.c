@@ -0,0 +1,92 @@
+/* Compara los bytes por clave de hash_t y hash_compacto_t con claves de 8
+ * caracteres: los que crece la memoria residente al guardarlas y los que
+ * estima hash_memoria o hash_compacto_memoria, junto con el tiempo de
+ * inserción y el de búsqueda, con la mitad de las búsquedas fallando. Cada
+ * tabla se mide en un proceso aparte para que la memoria que libera una no
+ * cuente en la otra.
+ *
+ *   gcc -O2 -std=gnu99 -I. -pthread -o bench_compacto benchmarks/bench_compacto.c \
+ *       hash.c hash_compacto.c hash_internador.c lista.c arbol.c memoria.c
+ *   ./bench_compacto [cantidad]
+ */
+
+#include "hash.h"
+#include "hash_compacto.h"
+#include "benchmarks/medir.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define CONSULTAS 4000000
+
+typedef struct medicion {
+    double residente;
+    double estimada;
+    double insertar;
+    double buscar;
+} medicion_t;
+
+/* Genera claves pseudoaleatorias entre 0 y 2n, así la mitad no está */
+static uint64_t siguiente(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static medicion_t medir(bool compacto, size_t n, size_t *encontradas)
+{
+    medicion_t medicion;
+    char clave[32];
+    hash_t* hash = NULL;
+    hash_compacto_t* hash_compacto = NULL;
+
+    long antes = memoria_residente();
+    double t = ahora();
+    if (compacto) hash_compacto = hash_compacto_crear(NULL);
+    else hash = hash_crear(NULL);
+    for (size_t i = 0; i < n; i++) {
+        sprintf(clave, "%08zu", i);
+        if (compacto) hash_compacto_guardar(hash_compacto, clave, clave);
+        else hash_guardar(hash, clave, clave);
+    }
+    medicion.insertar = (ahora() - t) / (double)n;
+    medicion.residente = (double)(memoria_residente() - antes) / (double)n;
+    medicion.estimada = (double)(compacto ? hash_compacto_memoria(hash_compacto) : hash_memoria(hash)) / (double)n;
+
+    uint64_t x = 88172645463325252u;
+    t = ahora();
+    for (size_t q = 0; q < CONSULTAS; q++) {
+        sprintf(clave, "%08zu", (size_t)(siguiente(&x) % (n * 2)));
+        *encontradas += compacto ? hash_compacto_pertenece(hash_compacto, clave) : hash_pertenece(hash, clave);
+    }
+    medicion.buscar = (ahora() - t) / CONSULTAS;
+
+    if (compacto) hash_compacto_destruir(hash_compacto);
+    else hash_destruir(hash);
+    return medicion;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    for (int compacto = 0; compacto < 2; compacto++) {
+        pid_t hijo = fork();
+        if (hijo < 0) return 1;
+        if (hijo) {
+            waitpid(hijo, NULL, 0);
+            continue;
+        }
+        size_t encontradas = 0;
+        medicion_t medicion = medir(compacto, n, &encontradas);
+        printf("%-8s n=%-9zu %6.1f bytes/clave residentes | %6.1f estimados | insertar %6.1f ns | buscar %6.1f ns (%zu)\n",
+               compacto ? "compacto" : "hash_t", n, medicion.residente, medicion.estimada,
+               medicion.insertar * 1e9, medicion.buscar * 1e9, encontradas);
+        return 0;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+/* Compara búsquedas en hash_t sin filtro y con el filtro de Bloom de 8 y 16
+ * bits por clave, con una carga donde la mayoría de las búsquedas fallan:
+ * tres búsquedas de claves que no están por cada una que sí. Informa los
+ * descartes y falsos positivos que cuenta el filtro, y la memoria que
+ * agrega según hash_memoria.
+ *
+ *   gcc -O2 -std=gnu99 -I. -pthread -o bench_filtro benchmarks/bench_filtro.c \
+ *       hash.c hash_internador.c lista.c arbol.c memoria.c
+ *   ./bench_filtro [cantidad]
+ */
+
+#include "hash.h"
+#include "benchmarks/medir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LARGO_CLAVE 24
+#define FALLOS_POR_ACIERTO 3
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    char (*claves)[LARGO_CLAVE] = malloc(n * LARGO_CLAVE);
+    char (*fallos)[LARGO_CLAVE] = malloc(n * FALLOS_POR_ACIERTO * LARGO_CLAVE);
+    if (!claves || !fallos) return 1;
+    for (size_t i = 0; i < n; i++) sprintf(claves[i], "clave:%zu", i);
+    for (size_t i = 0; i < n * FALLOS_POR_ACIERTO; i++) sprintf(fallos[i], "falta:%zu", i);
+
+    size_t bits[] = {0, 8, 16};
+    size_t memoria_sin_filtro = 0;
+    for (size_t b = 0; b < sizeof(bits) / sizeof(bits[0]); b++) {
+        hash_t* hash = hash_crear(NULL);
+        if (!hash || (bits[b] && !hash_filtro_activar(hash, bits[b]))) return 1;
+        for (size_t i = 0; i < n; i++) hash_guardar(hash, claves[i], claves[i]);
+
+        size_t encontradas = 0;
+        double t = ahora();
+        for (size_t i = 0; i < n; i++) {
+            for (size_t f = 0; f < FALLOS_POR_ACIERTO; f++) encontradas += hash_pertenece(hash, fallos[i * FALLOS_POR_ACIERTO + f]);
+            encontradas += hash_pertenece(hash, claves[i]);
+        }
+        t = ahora() - t;
+
+        size_t memoria = hash_memoria(hash);
+        if (!bits[b]) memoria_sin_filtro = memoria;
+        size_t busquedas = n * (FALLOS_POR_ACIERTO + 1);
+        printf("%2zu bits/clave: %6.1f ns/busqueda | descartes %5.1f%% | falsos positivos %5.2f%% de los fallos | +%zu KiB (%zu)\n",
+               bits[b], t / (double)busquedas * 1e9,
+               100.0 * (double)hash_filtro_descartes(hash) / (double)busquedas,
+               100.0 * (double)hash_filtro_falsos_positivos(hash) / (double)(n * FALLOS_POR_ACIERTO),
+               (memoria - memoria_sin_filtro) / 1024, encontradas);
+        hash_destruir(hash);
+    }
+
+    free(claves);
+    free(fallos);
+    return 0;
+}
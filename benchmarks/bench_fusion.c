@@ -0,0 +1,108 @@
+/* Compara hash_fusionar contra recorrer el origen con un iterador y guardar
+ * cada clave en el destino, con dos hashes de n / 2 claves que comparten la
+ * mitad. Después compara hash_diferencia con 1, 2, 4 y 8 hilos contra
+ * recorrer cada hash y buscar sus claves en el otro, entre un hash de n
+ * claves y otro corrido en n / 100 claves y con uno de cada 5 datos
+ * cambiados.
+ *
+ *   gcc -O2 -std=gnu99 -I. -pthread -o bench_fusion benchmarks/bench_fusion.c \
+ *       hash.c hash_internador.c lista.c arbol.c memoria.c
+ *   ./bench_fusion [cantidad]
+ */
+
+#include "hash.h"
+#include "benchmarks/medir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Guarda las claves entre desde y hasta, cambiando el dato de una de cada
+ * cambio claves (0 para ninguna) */
+static hash_t *llenar(size_t desde, size_t hasta, size_t cambio)
+{
+    char clave[32];
+    hash_t* hash = hash_crear(NULL);
+    if (!hash) return NULL;
+    for (size_t i = desde; i < hasta; i++) {
+        sprintf(clave, "clave:%zu", i);
+        hash_guardar(hash, clave, (void*)(cambio && i % cambio == 0 ? i + 1 : i));
+    }
+    return hash;
+}
+
+static bool contar(const char *clave, hash_cambio_t cambio, void *dato_viejo, void *dato_nuevo, void *extra)
+{
+    (void)clave;
+    (void)dato_viejo;
+    (void)dato_nuevo;
+    __atomic_fetch_add(&((size_t*)extra)[cambio], 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void fusionar(size_t n, bool a_mano)
+{
+    hash_t* destino = llenar(0, n / 2, 0);
+    hash_t* origen = llenar(n / 4, n / 4 + n / 2, 0);
+    if (!destino || !origen) exit(1);
+
+    double t = ahora();
+    if (!a_mano) {
+        if (!hash_fusionar(destino, origen, HASH_USAR_ORIGEN)) exit(1);
+    } else {
+        hash_iter_t* iter = hash_iter_crear(origen);
+        for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+            hash_guardar(destino, hash_iter_ver_actual(iter), hash_iter_ver_dato(iter));
+        }
+        hash_iter_destruir(iter);
+    }
+    t = ahora() - t;
+    printf("%-23s %6.0f ms (%zu claves en destino)\n", a_mano ? "iterar y guardar" : "hash_fusionar", t * 1e3,
+           hash_cantidad(destino));
+    hash_destruir(destino);
+    hash_destruir(origen);
+}
+
+static void diferencia_a_mano(const hash_t *viejo, const hash_t *nuevo, size_t cuenta[])
+{
+    hash_iter_t* iter = hash_iter_crear(viejo);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        const char* clave = hash_iter_ver_actual(iter);
+        if (!hash_pertenece(nuevo, clave)) cuenta[HASH_QUITADA]++;
+        else if (hash_obtener(nuevo, clave) != hash_iter_ver_dato(iter)) cuenta[HASH_CAMBIADA]++;
+    }
+    hash_iter_destruir(iter);
+    iter = hash_iter_crear(nuevo);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        if (!hash_pertenece(viejo, hash_iter_ver_actual(iter))) cuenta[HASH_AGREGADA]++;
+    }
+    hash_iter_destruir(iter);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+
+    fusionar(n, true);
+    fusionar(n, false);
+
+    hash_t* viejo = llenar(0, n, 0);
+    hash_t* nuevo = llenar(n / 100, n + n / 100, 5);
+    if (!viejo || !nuevo) return 1;
+
+    size_t hilos[] = {0, 1, 2, 4, 8};
+    for (size_t h = 0; h < sizeof(hilos) / sizeof(hilos[0]); h++) {
+        size_t cuenta[3] = {0, 0, 0};
+        double t = ahora();
+        if (!hilos[h]) diferencia_a_mano(viejo, nuevo, cuenta);
+        else if (!hash_diferencia(viejo, nuevo, NULL, contar, cuenta, hilos[h])) return 1;
+        t = ahora() - t;
+        if (!hilos[h]) printf("%-23s", "iterar y buscar");
+        else printf("hash_diferencia %zu hilo%s", hilos[h], hilos[h] > 1 ? "s" : " ");
+        printf(" %6.0f ms (+%zu -%zu ~%zu)\n", t * 1e3, cuenta[HASH_AGREGADA], cuenta[HASH_QUITADA],
+               cuenta[HASH_CAMBIADA]);
+    }
+
+    hash_destruir(viejo);
+    hash_destruir(nuevo);
+    return 0;
+}
@@ -0,0 +1,80 @@
+/* Compara recorrer las claves de un prefijo con hash_iter_crear_prefijo
+ * contra recorrer todo el hash con hash_iter_crear y filtrar con strncmp.
+ * Las claves son "usuario/UUUU/sesion/SSSSSS", con 1000 usuarios, y cada
+ * prefijo "usuario/UUUU/" tiene n / 1000 claves. También mide cuánto
+ * agrega el índice a guardar y el recorrido ordenado completo.
+ *
+ *   gcc -O2 -std=gnu99 -I. -pthread -o bench_indice benchmarks/bench_indice.c \
+ *       hash.c hash_internador.c lista.c arbol.c memoria.c
+ *   ./bench_indice [cantidad]
+ */
+
+#include "hash.h"
+#include "benchmarks/medir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define USUARIOS 1000
+#define PREFIJOS_INDICE 100
+#define PREFIJOS_FILTRO 5
+
+static double guardar(hash_t *hash, size_t n)
+{
+    char clave[64];
+    double t = ahora();
+    for (size_t i = 0; i < n; i++) {
+        sprintf(clave, "usuario/%04zu/sesion/%06zu", i % USUARIOS, i);
+        hash_guardar(hash, clave, NULL);
+    }
+    return (ahora() - t) / (double)n;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    char prefijo[32];
+
+    hash_t* sin_indice = hash_crear(NULL);
+    hash_t* hash = hash_crear(NULL);
+    if (!sin_indice || !hash || !hash_indice_activar(hash)) return 1;
+    printf("guardar: sin indice %.0f ns | con indice %.0f ns\n", guardar(sin_indice, n) * 1e9, guardar(hash, n) * 1e9);
+    hash_destruir(sin_indice);
+
+    size_t encontradas = 0;
+    double t = ahora();
+    for (size_t p = 0; p < PREFIJOS_INDICE; p++) {
+        sprintf(prefijo, "usuario/%04zu/", p * 7 % USUARIOS);
+        hash_iter_t* iter = hash_iter_crear_prefijo(hash, prefijo);
+        for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) encontradas++;
+        hash_iter_destruir(iter);
+    }
+    double indice = (ahora() - t) / PREFIJOS_INDICE;
+
+    size_t filtradas = 0;
+    t = ahora();
+    for (size_t p = 0; p < PREFIJOS_FILTRO; p++) {
+        sprintf(prefijo, "usuario/%04zu/", p * 7 % USUARIOS);
+        size_t largo = strlen(prefijo);
+        hash_iter_t* iter = hash_iter_crear(hash);
+        for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+            filtradas += !strncmp(hash_iter_ver_actual(iter), prefijo, largo);
+        }
+        hash_iter_destruir(iter);
+    }
+    double filtro = (ahora() - t) / PREFIJOS_FILTRO;
+    printf("prefijo de %zu claves: indice %.3f ms | recorrer y filtrar %.1f ms\n",
+           encontradas / PREFIJOS_INDICE, indice * 1e3, filtro * 1e3);
+    if (encontradas / PREFIJOS_INDICE != filtradas / PREFIJOS_FILTRO) return 1;
+
+    size_t recorridas = 0;
+    t = ahora();
+    hash_iter_t* iter = hash_iter_crear_rango(hash, NULL, NULL);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) recorridas++;
+    hash_iter_destruir(iter);
+    printf("recorrido ordenado de %zu claves: %.0f ms\n", recorridas, (ahora() - t) * 1e3);
+
+    hash_destruir(hash);
+    return 0;
+}
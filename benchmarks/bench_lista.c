@@ -0,0 +1,63 @@
+/* Mide lista_iterar y las inserciones y borrados por los extremos de una
+ * lista común contra una desenrollada.
+ *
+ *   gcc -O2 -std=gnu99 -I. -o bench_lista benchmarks/bench_lista.c lista.c
+ *   ./bench_lista [cantidad]
+ */
+
+#include "lista.h"
+#include "benchmarks/medir.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define VUELTAS_ITERAR 10
+
+static bool sumar(void *dato, void *extra)
+{
+    *(uintptr_t*)extra += (uintptr_t)dato;
+    return true;
+}
+
+static void medir_lista(const char *nombre, lista_t *lista, size_t n)
+{
+    double t0 = ahora();
+    for (size_t i = 0; i < n; i++) lista_insertar_ultimo(lista, (void*)(uintptr_t)i);
+    double t1 = ahora();
+
+    uintptr_t suma = 0;
+    for (int r = 0; r < VUELTAS_ITERAR; r++) lista_iterar(lista, sumar, &suma);
+    double t2 = ahora();
+
+    lista_iter_t iter;
+    lista_iter_inicializar(&iter, lista);
+    for (size_t i = 0; i < n; i++) {
+        if (i % 2) lista_iter_borrar(&iter);
+        else lista_iter_avanzar(&iter);
+    }
+    lista_iter_inicializar(&iter, lista);
+    for (size_t i = 0; i < n; i++) {
+        if (i % 2) lista_iter_insertar(&iter, (void*)(uintptr_t)i);
+        lista_iter_avanzar(&iter);
+    }
+    double t3 = ahora();
+
+    while (!lista_esta_vacia(lista)) lista_borrar_primero(lista);
+    double t4 = ahora();
+
+    printf("%-13s insertar %6.1f Mops/s | iterar %7.1f Melem/s | iter borrar+insertar %6.1f Mops/s | borrar %6.1f Mops/s (%lu)\n",
+           nombre, (double)n / (t1 - t0) / 1e6, VUELTAS_ITERAR * (double)n / (t2 - t1) / 1e6,
+           (double)n / (t3 - t2) / 1e6, (double)n / (t4 - t3) / 1e6, (unsigned long)suma);
+    lista_destruir(lista, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+
+    medir_lista("comun", lista_crear(), n);
+    medir_lista("desenrollada", lista_crear_desenrollada(), n);
+
+    return 0;
+}
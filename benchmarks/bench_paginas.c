@@ -0,0 +1,92 @@
+/* Mide búsquedas al azar en tablas grandes, donde cada búsqueda suele
+ * fallar en la TLB, con y sin páginas grandes transparentes, en hash_t y en
+ * hash_abierto_t. Informa cuánta memoria del proceso quedó respaldada por
+ * páginas grandes (AnonHugePages): si es 0, el kernel no las tiene
+ * habilitadas y las dos mediciones son equivalentes.
+ *
+ *   gcc -O2 -std=gnu99 -I. -pthread -o bench_paginas benchmarks/bench_paginas.c \
+ *       hash.c hash_abierto.c hash_internador.c lista.c arbol.c memoria.c
+ *   ./bench_paginas [cantidad]
+ */
+
+#include "hash.h"
+#include "hash_abierto.h"
+#include "benchmarks/medir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CONSULTAS 4000000
+
+/* Devuelve los KiB de memoria anónima respaldada por páginas grandes, o 0
+ * si no se puede leer (sólo Linux) */
+static long paginas_grandes_kib(void)
+{
+    FILE* f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f) return 0;
+    char linea[256];
+    long kib = 0;
+    while (fgets(linea, sizeof(linea), f)) {
+        if (!strncmp(linea, "AnonHugePages:", 14)) kib = atol(linea + 14);
+    }
+    fclose(f);
+    return kib;
+}
+
+/* Generador xorshift, para elegir claves al azar sin la latencia de rand */
+static unsigned long long siguiente(unsigned long long *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+/* Busca claves al azar, la mitad presentes, y devuelve ns por búsqueda */
+static double medir(hash_t *hash, hash_abierto_t *abierto, size_t n, size_t *encontradas)
+{
+    char clave[32];
+    unsigned long long x = 88172645463325252ULL;
+    double t = ahora();
+    for (size_t q = 0; q < CONSULTAS; q++) {
+        sprintf(clave, "k%llu", siguiente(&x) % (2 * n));
+        *encontradas += abierto ? hash_abierto_pertenece(abierto, clave) : hash_pertenece(hash, clave);
+    }
+    return (ahora() - t) / CONSULTAS * 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000000;
+    char clave[32];
+    size_t encontradas = 0;
+
+    for (int usar = 0; usar < 2; usar++) {
+        hash_t* hash = hash_crear(NULL);
+        hash_usar_paginas_grandes(hash, usar);
+        for (size_t i = 0; i < n; i++) {
+            sprintf(clave, "k%zu", i);
+            hash_guardar(hash, clave, NULL);
+        }
+        double ns = medir(hash, NULL, n, &encontradas);
+        printf("hash_t   n=%zu paginas grandes=%d: %6.1f ns/busqueda, AnonHugePages %ld MiB\n",
+               n, usar, ns, paginas_grandes_kib() / 1024);
+        hash_destruir(hash);
+    }
+
+    for (int usar = 0; usar < 2; usar++) {
+        hash_abierto_t* abierto = hash_abierto_crear(NULL);
+        hash_abierto_usar_paginas_grandes(abierto, usar);
+        for (size_t i = 0; i < n; i++) {
+            sprintf(clave, "k%zu", i);
+            hash_abierto_guardar(abierto, clave, NULL);
+        }
+        double ns = medir(NULL, abierto, n, &encontradas);
+        printf("abierto  n=%zu paginas grandes=%d: %6.1f ns/busqueda, AnonHugePages %ld MiB\n",
+               n, usar, ns, paginas_grandes_kib() / 1024);
+        hash_abierto_destruir(abierto);
+    }
+    printf("(%zu)\n", encontradas);
+    return 0;
+}
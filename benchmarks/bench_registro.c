@@ -0,0 +1,63 @@
+/* Mide cuántas modificaciones por segundo acepta hash_registro_t según cada
+ * cuántas sincroniza el archivo con el disco (1, 16, 256, o 0 para sólo al
+ * final), guardando datos de 64 bytes sobre 50000 claves. También mide
+ * compactar el registro y volver a abrirlo, que lo relee entero.
+ *
+ *   gcc -O2 -std=gnu99 -I. -pthread -o bench_registro benchmarks/bench_registro.c \
+ *       hash_registro.c hash.c hash_internador.c lista.c arbol.c memoria.c
+ *   ./bench_registro [ruta]
+ *
+ * La ruta por omisión está en el directorio actual, ya que /tmp suele estar
+ * en memoria y ahí fsync no cuesta nada.
+ */
+
+#include "hash_registro.h"
+#include "benchmarks/medir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CLAVES 50000
+#define TAM_DATO 64
+
+int main(int argc, char *argv[])
+{
+    const char* ruta = argc > 1 ? argv[1] : "bench_registro.log";
+    size_t intervalos[] = {1, 16, 256, 0};
+    char dato[TAM_DATO];
+    memset(dato, 'x', sizeof(dato));
+
+    for (size_t c = 0; c < sizeof(intervalos) / sizeof(intervalos[0]); c++) {
+        unlink(ruta);
+        hash_registro_t* reg = hash_registro_abrir(ruta, intervalos[c]);
+        if (!reg) return 1;
+        // Con un fsync por operación, menos operaciones alcanzan para medir
+        size_t operaciones = intervalos[c] == 1 ? 2000 : 200000;
+
+        char clave[32];
+        double t = ahora();
+        for (size_t i = 0; i < operaciones; i++) {
+            sprintf(clave, "clave:%zu", i % CLAVES);
+            if (!hash_registro_guardar(reg, clave, dato, sizeof(dato))) return 1;
+        }
+        hash_registro_sincronizar(reg);
+        t = ahora() - t;
+        printf("sincronizar cada %-4zu %9.0f ops/s\n", intervalos[c], (double)operaciones / t);
+
+        t = ahora();
+        hash_registro_compactar(reg);
+        double compactar = ahora() - t;
+        hash_registro_cerrar(reg);
+
+        t = ahora();
+        reg = hash_registro_abrir(ruta, 0);
+        if (!reg) return 1;
+        printf("    compactar %6.1f ms | reabrir %6.1f ms (%zu claves)\n", compactar * 1e3, (ahora() - t) * 1e3,
+               hash_registro_cantidad(reg));
+        hash_registro_cerrar(reg);
+    }
+    unlink(ruta);
+    return 0;
+}
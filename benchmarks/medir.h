@@ -0,0 +1,31 @@
+#ifndef MEDIR_H
+#define MEDIR_H
+
+#include <stdio.h>
+#include <time.h>
+
+/* Funciones auxiliares de los programas de medición. Cada programa se
+ * compila por separado desde la raíz del repositorio; el comando está al
+ * principio de cada archivo. */
+
+// Devuelve el tiempo actual en segundos, de un reloj monótono.
+static inline double ahora(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// Devuelve la memoria residente del proceso en bytes, o 0 si no se la puede
+// leer (sólo Linux).
+static inline long memoria_residente(void)
+{
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    long total = 0, residente = 0;
+    if (fscanf(f, "%ld %ld", &total, &residente) != 2) residente = 0;
+    fclose(f);
+    return residente * 4096;
+}
+
+#endif // MEDIR_H
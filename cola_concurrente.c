@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200112L
+#include "cola_concurrente.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define TAM_LINEA_CACHE 64
+#define CAPACIDAD_MAXIMA_COLA (SIZE_MAX / 2 / sizeof(celda_t))
+
+/* Cola acotada de Dmitry Vyukov. Cada celda tiene un número de secuencia
+ * que indica de quién es el turno: la celda de la posición p está libre
+ * para el productor que tome p cuando su secuencia es p, y lista para el
+ * consumidor que tome p cuando es p + 1. Al desencolarla pasa a
+ * p + capacidad, el turno del productor de la próxima vuelta.
+ * Productores y consumidores se reparten las posiciones con un
+ * compare-and-swap sobre encolar y desencolar, que están en líneas de caché
+ * distintas para que unos no invaliden la de los otros. */
+typedef struct celda {
+    atomic_size_t secuencia;
+    void* dato;
+} celda_t;
+
+struct cola_concurrente {
+    celda_t* celdas;
+    size_t mascara;
+    char relleno1[TAM_LINEA_CACHE - sizeof(celda_t*) - sizeof(size_t)];
+    atomic_size_t encolar;
+    char relleno2[TAM_LINEA_CACHE - sizeof(atomic_size_t)];
+    atomic_size_t desencolar;
+    char relleno3[TAM_LINEA_CACHE - sizeof(atomic_size_t)];
+};
+
+cola_concurrente_t *cola_concurrente_crear(size_t capacidad){
+    // Así redondeada a potencia de 2, el arreglo no pasa de SIZE_MAX bytes
+    if (capacidad > CAPACIDAD_MAXIMA_COLA) return NULL;
+    size_t tam = 2;
+    while (tam < capacidad) tam *= 2;
+
+    cola_concurrente_t* cola;
+    if (posix_memalign((void**)&cola, TAM_LINEA_CACHE, sizeof(cola_concurrente_t))) return NULL;
+    if (posix_memalign((void**)&cola->celdas, TAM_LINEA_CACHE, tam * sizeof(celda_t))){
+        free(cola);
+        return NULL;
+    }
+    for (size_t i = 0; i < tam; i++) atomic_init(&cola->celdas[i].secuencia, i);
+    cola->mascara = tam - 1;
+    atomic_init(&cola->encolar, 0);
+    atomic_init(&cola->desencolar, 0);
+    return cola;
+}
+
+bool cola_concurrente_encolar(cola_concurrente_t *cola, void *dato){
+    size_t pos = atomic_load_explicit(&cola->encolar, memory_order_relaxed);
+    celda_t* celda;
+    while (true) {
+        celda = &cola->celdas[pos & cola->mascara];
+        size_t secuencia = atomic_load_explicit(&celda->secuencia, memory_order_acquire);
+        intptr_t diferencia = (intptr_t)secuencia - (intptr_t)pos;
+        if (diferencia == 0) {
+            if (atomic_compare_exchange_weak_explicit(&cola->encolar, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) break;
+        }
+        // La celda todavía tiene el dato de la vuelta anterior
+        else if (diferencia < 0) return false;
+        else pos = atomic_load_explicit(&cola->encolar, memory_order_relaxed);
+    }
+    celda->dato = dato;
+    atomic_store_explicit(&celda->secuencia, pos + 1, memory_order_release);
+    return true;
+}
+
+bool cola_concurrente_desencolar(cola_concurrente_t *cola, void **dato){
+    size_t pos = atomic_load_explicit(&cola->desencolar, memory_order_relaxed);
+    celda_t* celda;
+    while (true) {
+        celda = &cola->celdas[pos & cola->mascara];
+        size_t secuencia = atomic_load_explicit(&celda->secuencia, memory_order_acquire);
+        intptr_t diferencia = (intptr_t)secuencia - (intptr_t)(pos + 1);
+        if (diferencia == 0) {
+            if (atomic_compare_exchange_weak_explicit(&cola->desencolar, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) break;
+        }
+        // Ningún productor llegó todavía a esta celda
+        else if (diferencia < 0) return false;
+        else pos = atomic_load_explicit(&cola->desencolar, memory_order_relaxed);
+    }
+    *dato = celda->dato;
+    atomic_store_explicit(&celda->secuencia, pos + cola->mascara + 1, memory_order_release);
+    return true;
+}
+
+size_t cola_concurrente_cantidad(const cola_concurrente_t *cola){
+    size_t desencolar = atomic_load_explicit(&cola->desencolar, memory_order_relaxed);
+    size_t encolar = atomic_load_explicit(&cola->encolar, memory_order_relaxed);
+    return encolar > desencolar ? encolar - desencolar : 0;
+}
+
+size_t cola_concurrente_capacidad(const cola_concurrente_t *cola){
+    return cola->mascara + 1;
+}
+
+void cola_concurrente_destruir(cola_concurrente_t *cola, void (*destruir_dato)(void *)){
+    void* dato;
+    while (destruir_dato && cola_concurrente_desencolar(cola, &dato)) destruir_dato(dato);
+    free(cola->celdas);
+    free(cola);
+}
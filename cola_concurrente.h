@@ -0,0 +1,55 @@
+#ifndef COLA_CONCURRENTE_H
+#define COLA_CONCURRENTE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+
+/* ******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS
+ * *****************************************************************/
+
+/* La cola concurrente es una cola acotada de punteros genéricos, que
+ * admite varios productores y varios consumidores a la vez sin usar locks.
+ * No pide memoria después de crearla: los datos se guardan en un arreglo
+ * circular de celdas que se reutilizan, por lo que no hay nodos que
+ * reciclar ni que liberar mientras otro hilo puede estar leyéndolos. */
+
+typedef struct cola_concurrente cola_concurrente_t;
+
+
+/* ******************************************************************
+ *                    PRIMITIVAS DE LA COLA
+ * *****************************************************************/
+
+// Crea una cola con lugar para capacidad elementos, redondeada hacia arriba
+// a una potencia de 2.
+// Post: devuelve una nueva cola vacía, o NULL si no hubo memoria o la
+// capacidad es tan grande que el arreglo de celdas no entra en un size_t.
+cola_concurrente_t *cola_concurrente_crear(size_t capacidad);
+
+// Agrega un elemento al final de la cola. Devuelve falso si la cola estaba
+// llena. Puede llamarse desde varios hilos a la vez.
+// Pre: la cola fue creada.
+bool cola_concurrente_encolar(cola_concurrente_t *cola, void *dato);
+
+// Quita el primer elemento de la cola y lo guarda en dato. Devuelve falso si
+// la cola estaba vacía. Puede llamarse desde varios hilos a la vez.
+// Pre: la cola fue creada.
+bool cola_concurrente_desencolar(cola_concurrente_t *cola, void **dato);
+
+// Devuelve la cantidad de elementos de la cola. Con otros hilos usándola,
+// es sólo una aproximación.
+// Pre: la cola fue creada.
+size_t cola_concurrente_cantidad(const cola_concurrente_t *cola);
+
+// Devuelve la capacidad de la cola.
+// Pre: la cola fue creada.
+size_t cola_concurrente_capacidad(const cola_concurrente_t *cola);
+
+// Destruye la cola. Si se recibe la función destruir_dato por parámetro,
+// para cada uno de los elementos de la cola llama a destruir_dato.
+// Pre: la cola fue creada y ningún otro hilo la está usando.
+void cola_concurrente_destruir(cola_concurrente_t *cola, void (*destruir_dato)(void *));
+
+#endif // COLA_CONCURRENTE_H
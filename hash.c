@@ -1,35 +1,154 @@
 #define _GNU_SOURCE 1
 #include "hash.h"
 #include "lista.h"
+#include "arbol.h"
+#include "memoria.h"
+#include "mezcla.h"
+#include "hash_internador.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <pthread.h>
 #define TAM_INICIAL 17
 #define CRIT_AGRANDAR 3
 #define CRIT_ACHICAR 2
 #define FACTOR_CARGA_AMPLIACION 2
 #define FACTOR_CARGA_REDUCCION 4
+#define RANURAS_RUEDA 256
+#define TAM_SEGMENTO 64
+#define CLAVES_POR_BLOQUE 16
+#define MAX_VARINT 10
+#define TAM_BLOQUE_FILTRO 64
+#define PALABRAS_BLOQUE (TAM_BLOQUE_FILTRO / sizeof(uint64_t))
+#define BITS_POR_CONSULTA 6
+#define TAM_LINEA_CACHE 64
+// Nodo de lista.h de cada campo más su parte de la lista de su posición
+#define MEMORIA_LISTA_POR_CAMPO 64
 
+/* Los segmentos que crea crear_segmentos se piden en un único bloque junto
+ * con su directorio, cada uno alineado a línea de caché (ver memoria.h).
+ * vivos cuenta el directorio y los segmentos del bloque que siguen en uso, y
+ * el bloque se libera con el último. */
+typedef struct bloque_segmentos{
+    atomic_size_t vivos;
+    size_t tam;
+} bloque_segmentos_t;
+
+/* Las listas del hash se agrupan en segmentos de TAM_SEGMENTO listas, que
+ * pueden estar compartidos con instantáneas. Un segmento con más de una
+ * referencia no se modifica: antes de escribir en él, el hash lo copia.
+ * Las copias se piden sueltas, sin bloque. */
+typedef struct segmento{
+    atomic_size_t referencias;
+    bloque_segmentos_t* bloque;
+    lista_t* listas[TAM_SEGMENTO];
+} segmento_t;
+
+/* generacion cambia con cada inserción, borrado, redimensión o copia de un
+ * segmento, para que los iteradores detecten que el hash se modificó por
+ * fuera de ellos.
+ * Los campos con vencimiento están además en la rueda de vencimientos: la
+ * ranura t % RANURAS_RUEDA tiene los que vencen en el instante t, o en t más
+ * una cantidad de vueltas. rueda_cursor es el próximo instante a procesar, y
+ * rueda_pendientes cuántos campos de su ranura faltan revisar.
+ * Mientras haya instantáneas, las claves y datos que se borran o reemplazan
+ * se guardan en claves_pendientes y datos_pendientes, porque las
+ * instantáneas pueden seguir usándolos; las fichas que libera la rueda
+ * esperan también en claves_pendientes.
+ * Las claves congeladas están codificadas en claves, de tam_claves bytes; el
+ * resto son copias propias de cada campo. clave_obtenida es el buffer donde
+ * hash_obtener_clave decodifica las claves congeladas.
+ * indice, si está activo, tiene las claves del hash ordenadas; clave_indice
+ * es el buffer donde se decodifica una clave congelada que se inserta o
+ * borra del índice.
+ * destruyendo indica que se empezó a destruir el hash por partes.
+ * memoria_claves es lo que ocupan las copias de las claves no congeladas, y
+ * limite_memoria el máximo para hash_memoria, o 0 si no hay.
+ * Con internador, las claves de los campos son las copias internadas, que
+ * no son del hash: no se liberan ni se cuentan en memoria_claves. */
 struct hash{
-    lista_t** listas;
+    segmento_t** segmentos;
     size_t cantidad;
     size_t capacidad;
     void (*hash_destruir_dato_t)(void *);
+    lista_t** rueda;
+    size_t ahora;
+    size_t rueda_cursor;
+    size_t rueda_pendientes;
+    size_t generacion;
+    atomic_size_t instantaneas;
+    lista_t* claves_pendientes;
+    lista_t* datos_pendientes;
+    unsigned char* claves;
+    size_t tam_claves;
+    size_t largo_maximo;
+    char* clave_obtenida;
+    struct filtro* filtro;
+    arbol_t* indice;
+    char* clave_indice;
+    bool destruyendo;
+    size_t destruccion;
+    bool paginas_grandes;
+    size_t memoria_claves;
+    size_t limite_memoria;
+    hash_internador_t* internador;
 };
 
+/* Filtro de Bloom por bloques: cada clave marca BITS_POR_CONSULTA bits dentro
+ * de un único bloque del tamaño de una línea de caché, por lo que consultarla
+ * lee una sola línea. No admite borrar claves: los borrados se cuentan, y el
+ * filtro se reconstruye cuando hay más borrados que claves o al
+ * redimensionar el hash. Las estadísticas se actualizan también en las
+ * consultas sobre un hash const, que pueden hacerse desde varios hilos a la
+ * vez, por lo que son atómicas. */
+typedef struct filtro{
+    uint64_t* bloques;
+    size_t cant_bloques;
+    size_t bits_por_clave;
+    size_t borrados;
+    atomic_size_t consultas;
+    atomic_size_t descartes;
+    atomic_size_t falsos_positivos;
+} filtro_t;
+
+/* La rueda guarda fichas en lugar de campos, para que un campo pueda
+ * copiarse o liberarse sin buscarlo en la rueda: basta con actualizar su
+ * ficha. Una ficha sin campo la libera la rueda al llegar a su ranura.
+ * Las copias de los campos que quedan en las instantáneas siguen apuntando
+ * a la ficha y leyendo su vencimiento, así que mientras haya instantáneas
+ * no se cambia el vencimiento de una ficha ni se la libera. */
+typedef struct ficha{
+    struct campo* campo;
+    size_t vencimiento;
+} ficha_t;
+
+/* Sólo los campos con ficha tienen vencimiento, guardado en la ficha para
+ * que los campos sin vencimiento no paguen por él */
 typedef struct campo{
     char* clave;
     void* valor;
+    size_t hash;
+    ficha_t* ficha;
 } campo_t;
 
+size_t cant_segmentos(size_t capacidad){
+    return (capacidad + TAM_SEGMENTO - 1) / TAM_SEGMENTO;
+}
+
+lista_t* lista_en(segmento_t** segmentos, size_t i){
+    return segmentos[i / TAM_SEGMENTO]->listas[i % TAM_SEGMENTO];
+}
+
 /* Busca la próxima posición con una lista no vacía.
- * Si el valor devuelto es igual a la capacidad del hash, 
+ * Si el valor devuelto es igual a la capacidad del hash,
  * entonces no hay más listas por recorrer */
 size_t encontrar_prox_lista(const hash_t* hash, size_t n){
     size_t i = n;
 
-    while (i < hash->capacidad && (!hash->listas[i] || lista_esta_vacia(hash->listas[i]))){
+    while (i < hash->capacidad && (!lista_en(hash->segmentos, i) || lista_esta_vacia(lista_en(hash->segmentos, i)))){
         i++;
     }
 
@@ -37,22 +156,65 @@ size_t encontrar_prox_lista(const hash_t* hash, size_t n){
 }
 
 //Función de hash
-size_t f_hash(size_t capacidad, const char *str){
+size_t hash_calcular(const char *str){
     size_t valor = 5381;
     int c;
     while ((c = *str++)){
         valor = ((valor << 5) + valor) + c;
     }
 
-    return valor % capacidad;
+    return valor;
+}
+
+size_t redondear_a_linea(size_t tam){
+    return (tam + TAM_LINEA_CACHE - 1) / TAM_LINEA_CACHE * TAM_LINEA_CACHE;
+}
+
+/* El bloque tiene su cabecera, el directorio y los segmentos, en ese orden */
+size_t tam_bloque_segmentos(size_t capacidad){
+    size_t n = cant_segmentos(capacidad);
+    return redondear_a_linea(sizeof(bloque_segmentos_t)) + redondear_a_linea(n * sizeof(segmento_t*)) + n * redondear_a_linea(sizeof(segmento_t));
+}
+
+/* Crea los segmentos vacíos para la capacidad dada y devuelve su directorio */
+segmento_t** crear_segmentos(size_t capacidad, bool paginas_grandes){
+    size_t n = cant_segmentos(capacidad);
+    size_t tam = tam_bloque_segmentos(capacidad);
+    bloque_segmentos_t* bloque = memoria_reservar(tam, paginas_grandes);
+    if (!bloque) return NULL;
+    atomic_init(&bloque->vivos, n + 1);
+    bloque->tam = tam;
+    segmento_t** segmentos = (segmento_t**)((char*)bloque + redondear_a_linea(sizeof(bloque_segmentos_t)));
+    char* primero = (char*)segmentos + redondear_a_linea(n * sizeof(segmento_t*));
+    for (size_t s = 0; s < n; s++){
+        segmentos[s] = (segmento_t*)(primero + s * redondear_a_linea(sizeof(segmento_t)));
+        atomic_init(&segmentos[s]->referencias, 1);
+        segmentos[s]->bloque = bloque;
+    }
+    return segmentos;
+}
+
+void soltar_bloque(bloque_segmentos_t* bloque){
+    if (atomic_fetch_sub(&bloque->vivos, 1) == 1) memoria_liberar(bloque, bloque->tam);
+}
+
+// Libera un segmento que ya no tiene referencias
+void liberar_segmento(segmento_t* segmento){
+    if (segmento->bloque) soltar_bloque(segmento->bloque);
+    else free(segmento);
+}
+
+// Libera un directorio devuelto por crear_segmentos
+void liberar_directorio(segmento_t** segmentos){
+    soltar_bloque((bloque_segmentos_t*)((char*)segmentos - redondear_a_linea(sizeof(bloque_segmentos_t))));
 }
 
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato){
     hash_t* hash = malloc(sizeof(hash_t));
     if (!hash) return NULL;
-    
-    hash->listas = calloc(TAM_INICIAL, sizeof(lista_t*));
-    if (!hash->listas){
+
+    hash->segmentos = crear_segmentos(TAM_INICIAL, false);
+    if (!hash->segmentos){
         free(hash);
         return NULL;
     }
@@ -60,131 +222,761 @@ hash_t *hash_crear(hash_destruir_dato_t destruir_dato){
     hash->cantidad = 0;
     hash->capacidad = TAM_INICIAL;
     hash->hash_destruir_dato_t = destruir_dato;
+    hash->rueda = NULL;
+    hash->ahora = 0;
+    hash->rueda_cursor = 0;
+    hash->rueda_pendientes = 0;
+    hash->generacion = 0;
+    atomic_init(&hash->instantaneas, 0);
+    hash->claves_pendientes = NULL;
+    hash->datos_pendientes = NULL;
+    hash->claves = NULL;
+    hash->tam_claves = 0;
+    hash->largo_maximo = 0;
+    hash->clave_obtenida = NULL;
+    hash->filtro = NULL;
+    hash->indice = NULL;
+    hash->clave_indice = NULL;
+    hash->destruyendo = false;
+    hash->destruccion = 0;
+    hash->paginas_grandes = false;
+    hash->memoria_claves = 0;
+    hash->limite_memoria = 0;
+    hash->internador = NULL;
     return hash;
 }
 
-lista_iter_t* iter_buscar_clave(lista_t* lista, const char* clave){
-    lista_iter_t* iter = lista_iter_crear(lista);
-    if (!iter) return NULL; 
+bool campo_vencido(const campo_t* campo, size_t ahora){
+    return campo->ficha && campo->ficha->vencimiento <= ahora;
+}
+
+/* Claves congeladas
+ * Se guardan ordenadas y con codificación incremental (front coding): cada
+ * clave se codifica como la cantidad de bytes que comparte con la anterior,
+ * el largo del resto y el resto. Cada CLAVES_POR_BLOQUE claves se empieza un
+ * bloque nuevo, cuya primera clave no comparte nada. Todos los números son
+ * varints, y cada clave empieza con la distancia hasta el inicio de su
+ * bloque, para poder decodificarla a partir de ella sola. El campo de una
+ * clave congelada apunta al inicio de su codificación. */
+
+unsigned char* escribir_varint(unsigned char* destino, size_t n){
+    while (n >= 0x80){
+        *destino++ = (unsigned char)(n | 0x80);
+        n >>= 7;
+    }
+    *destino++ = (unsigned char)n;
+    return destino;
+}
+
+const unsigned char* leer_varint(const unsigned char* origen, size_t* n){
+    size_t valor = 0;
+    unsigned corrimiento = 0;
+    while (*origen & 0x80){
+        valor |= (size_t)(*origen++ & 0x7F) << corrimiento;
+        corrimiento += 7;
+    }
+    *n = valor | (size_t)*origen++ << corrimiento;
+    return origen;
+}
+
+/* Lee la clave codificada en p, dejando en sufijo el resto que no comparte
+ * con la anterior, y devuelve dónde empieza la siguiente */
+const unsigned char* leer_clave_codificada(const unsigned char* p, size_t* compartido, size_t* largo, const unsigned char** sufijo){
+    size_t retroceso;
+    p = leer_varint(p, &retroceso);
+    p = leer_varint(p, compartido);
+    p = leer_varint(p, largo);
+    *sufijo = p;
+    return p + *largo;
+}
+
+const unsigned char* inicio_bloque(const unsigned char* codificada){
+    size_t retroceso;
+    leer_varint(codificada, &retroceso);
+    return codificada - retroceso;
+}
+
+bool es_congelada(const hash_t* hash, const char* clave){
+    return (uintptr_t)clave - (uintptr_t)hash->claves < hash->tam_claves;
+}
+
+/* Decodifica la clave congelada en destino, que debe tener lugar para
+ * largo_maximo + 1 bytes */
+void decodificar_clave(const char* congelada, char* destino){
+    const unsigned char* codificada = (const unsigned char*)congelada;
+    const unsigned char* p = inicio_bloque(codificada);
+    size_t compartido, largo;
+    const unsigned char* sufijo;
+    while (true){
+        const unsigned char* prox = leer_clave_codificada(p, &compartido, &largo, &sufijo);
+        memcpy(destino + compartido, sufijo, largo);
+        if (p == codificada) break;
+        p = prox;
+    }
+    destino[compartido + largo] = '\0';
+}
+
+/* Compara la clave congelada con otra sin decodificarla: recorre su bloque
+ * llevando cuántos bytes coinciden entre la clave buscada y cada clave del
+ * bloque. */
+bool congelada_igual(const char* congelada, const char* clave){
+    const unsigned char* codificada = (const unsigned char*)congelada;
+    const unsigned char* p = inicio_bloque(codificada);
+    size_t coinciden = 0, compartido, largo;
+    const unsigned char* sufijo;
+    while (true){
+        const unsigned char* prox = leer_clave_codificada(p, &compartido, &largo, &sufijo);
+        // Si comparte más de lo que coincidía, sigue difiriendo en el mismo byte
+        if (compartido <= coinciden){
+            coinciden = compartido;
+            while (coinciden < compartido + largo && clave[coinciden] == (char)sufijo[coinciden - compartido]) coinciden++;
+        }
+        if (p == codificada) return coinciden == compartido + largo && clave[coinciden] == '\0';
+        p = prox;
+    }
+}
+
+/* Compara la clave con la congelada sin decodificarla, como strcmp(clave,
+ * congelada). Igual que congelada_igual, pero llevando además el byte de la
+ * clave del bloque en la primera posición en que difiere de la buscada. */
+int comparar_congelada(const char* clave, const char* congelada){
+    const unsigned char* codificada = (const unsigned char*)congelada;
+    const unsigned char* p = inicio_bloque(codificada);
+    size_t coinciden = 0, compartido, largo;
+    unsigned char distinto = '\0';
+    const unsigned char* sufijo;
+    while (true){
+        const unsigned char* prox = leer_clave_codificada(p, &compartido, &largo, &sufijo);
+        // Si comparte más de lo que coincidía, difiere en el mismo byte
+        if (compartido <= coinciden){
+            coinciden = compartido;
+            while (coinciden < compartido + largo && clave[coinciden] == (char)sufijo[coinciden - compartido]) coinciden++;
+            distinto = coinciden < compartido + largo ? sufijo[coinciden - compartido] : '\0';
+        }
+        if (p == codificada) return (int)(unsigned char)clave[coinciden] - (int)distinto;
+        p = prox;
+    }
+}
+
+/* Las claves internadas se buscan con la misma copia que se guardó, así que
+ * casi siempre alcanza con comparar los punteros */
+bool claves_iguales(const hash_t* hash, const char* guardada, const char* clave){
+    if (guardada == clave) return true;
+    if (es_congelada(hash, guardada)) return congelada_igual(guardada, clave);
+    return !strcmp(guardada, clave);
+}
+
+/* Libera la clave, o la deja pendiente si hay instantáneas. Si no se puede
+ * dejarla pendiente se la pierde, ya que liberarla no sería seguro. */
+void liberar_clave(hash_t* hash, char* clave){
+    if (es_congelada(hash, clave) || hash->internador) return;
+    if (atomic_load(&hash->instantaneas)){
+        lista_insertar_ultimo(hash->claves_pendientes, clave);
+        return;
+    }
+    free(clave);
+}
+
+/* Libera la ficha, o la deja pendiente si hay instantáneas. Se libera con
+ * free como las claves, así que espera con ellas. */
+void liberar_ficha(hash_t* hash, ficha_t* ficha){
+    if (atomic_load(&hash->instantaneas)){
+        lista_insertar_ultimo(hash->claves_pendientes, ficha);
+        return;
+    }
+    free(ficha);
+}
+
+/* Destruye el dato, o lo deja pendiente si hay instantáneas */
+void destruir_dato(hash_t* hash, void* dato){
+    if (!hash->hash_destruir_dato_t) return;
+    if (atomic_load(&hash->instantaneas)){
+        lista_insertar_ultimo(hash->datos_pendientes, dato);
+        return;
+    }
+    hash->hash_destruir_dato_t(dato);
+}
+
+/* Libera las claves y datos pendientes, si ya no quedan instantáneas */
+void liberar_pendientes(hash_t* hash){
+    if (!hash->claves_pendientes || atomic_load(&hash->instantaneas)) return;
+    while (!lista_esta_vacia(hash->claves_pendientes)){
+        free(lista_borrar_primero(hash->claves_pendientes));
+    }
+    while (!lista_esta_vacia(hash->datos_pendientes)){
+        hash->hash_destruir_dato_t(lista_borrar_primero(hash->datos_pendientes));
+    }
+}
+
+/* Quita el vencimiento del campo, dejando su ficha para que la libere la rueda */
+void quitar_ficha(campo_t* campo){
+    if (!campo->ficha) return;
+    campo->ficha->campo = NULL;
+    campo->ficha = NULL;
+}
+
+void liberar_campo(hash_t* hash, campo_t* campo){
+    if (!es_congelada(hash, campo->clave) && !hash->internador) hash->memoria_claves -= strlen(campo->clave) + 1;
+    liberar_clave(hash, campo->clave);
+    quitar_ficha(campo);
+    free(campo);
+}
+
+/* Suelta una referencia al segmento. Quien suelta la última referencia de
+ * un segmento compartido sólo libera sus listas y campos: las claves y los
+ * datos son del hash. */
+void soltar_segmento(segmento_t* segmento){
+    if (atomic_fetch_sub(&segmento->referencias, 1) != 1) return;
+    for (size_t i = 0; i < TAM_SEGMENTO; i++){
+        if (segmento->listas[i]) lista_destruir(segmento->listas[i], free);
+    }
+    liberar_segmento(segmento);
+}
+
+/* Reemplaza el segmento s por una copia propia si está compartido. Las
+ * copias de los campos comparten clave y dato con los originales, y pasan a
+ * ser los campos de sus fichas y del índice. */
+bool hacer_propio(hash_t* hash, size_t s){
+    segmento_t* viejo = hash->segmentos[s];
+    if (atomic_load(&viejo->referencias) == 1) return true;
+
+    segmento_t* nuevo = calloc(1, sizeof(segmento_t));
+    if (!nuevo) return false;
+    atomic_init(&nuevo->referencias, 1);
+    for (size_t i = 0; i < TAM_SEGMENTO; i++){
+        if (!viejo->listas[i]) continue;
+        nuevo->listas[i] = lista_crear();
+        lista_iter_t iter;
+        lista_iter_inicializar(&iter, viejo->listas[i]);
+        while (nuevo->listas[i] && !lista_iter_al_final(&iter)){
+            campo_t* copia = malloc(sizeof(campo_t));
+            if (copia) *copia = *(campo_t*)lista_iter_ver_actual(&iter);
+            if (!copia || !lista_insertar_ultimo(nuevo->listas[i], copia)){
+                free(copia);
+                break;
+            }
+            lista_iter_avanzar(&iter);
+        }
+        if (!nuevo->listas[i] || !lista_iter_al_final(&iter)){
+            for (size_t k = 0; k <= i; k++){
+                if (nuevo->listas[k]) lista_destruir(nuevo->listas[k], free);
+            }
+            free(nuevo);
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < TAM_SEGMENTO; i++){
+        lista_iter_t iter;
+        if (!nuevo->listas[i]) continue;
+        lista_iter_inicializar(&iter, nuevo->listas[i]);
+        while (!lista_iter_al_final(&iter)){
+            campo_t* copia = lista_iter_ver_actual(&iter);
+            if (copia->ficha) copia->ficha->campo = copia;
+            if (hash->indice) arbol_reemplazar(hash->indice, copia);
+            lista_iter_avanzar(&iter);
+        }
+    }
+    hash->segmentos[s] = nuevo;
+    hash->generacion++;
+    soltar_segmento(viejo);
+    return true;
+}
+
+/* Devuelve la dirección de la lista i del hash para modificarla, copiando
+ * antes su segmento si está compartido. Devuelve NULL si no pudo copiarlo. */
+lista_t** lista_escritura(hash_t* hash, size_t i){
+    if (!hacer_propio(hash, i / TAM_SEGMENTO)) return NULL;
+    return &hash->segmentos[i / TAM_SEGMENTO]->listas[i % TAM_SEGMENTO];
+}
+
+/* Devuelve el bloque de la clave de hash h, y en bits las posiciones dentro
+ * del bloque, de a 9 bits */
+uint64_t* bloque_filtro(const filtro_t* filtro, size_t h, uint64_t* bits){
+    uint64_t x = mezclar((uint64_t)h);
+    *bits = mezclar(x ^ 0x9e3779b97f4a7c15ULL);
+    return filtro->bloques + (size_t)(x & (filtro->cant_bloques - 1)) * PALABRAS_BLOQUE;
+}
+
+void filtro_agregar(filtro_t* filtro, size_t h){
+    uint64_t bits;
+    uint64_t* bloque = bloque_filtro(filtro, h, &bits);
+    for (int k = 0; k < BITS_POR_CONSULTA; k++, bits >>= 9){
+        bloque[(bits & 511) >> 6] |= (uint64_t)1 << (bits & 63);
+    }
+}
+
+bool filtro_puede_estar(const filtro_t* filtro, size_t h){
+    uint64_t bits;
+    const uint64_t* bloque = bloque_filtro(filtro, h, &bits);
+    for (int k = 0; k < BITS_POR_CONSULTA; k++, bits >>= 9){
+        if (!(bloque[(bits & 511) >> 6] & ((uint64_t)1 << (bits & 63)))) return false;
+    }
+    return true;
+}
+
+/* Devuelve la cantidad de bloques del filtro para la capacidad dada, con
+ * lugar para la cantidad de claves a la que el hash se agranda */
+size_t bloques_filtro(size_t capacidad, size_t bits_por_clave){
+    size_t bits = capacidad * FACTOR_CARGA_AMPLIACION * bits_por_clave;
+    size_t cant_bloques = 1;
+    while (cant_bloques * TAM_BLOQUE_FILTRO * 8 < bits) cant_bloques *= 2;
+    return cant_bloques;
+}
+
+/* Crea los bloques del filtro para la capacidad dada y los llena con las
+ * claves del hash. Si no hay memoria deja el filtro anterior, que sigue
+ * siendo correcto aunque dé más falsos positivos. */
+bool reconstruir_filtro(hash_t* hash, size_t capacidad){
+    filtro_t* filtro = hash->filtro;
+    size_t cant_bloques = bloques_filtro(capacidad, filtro->bits_por_clave);
+    uint64_t* bloques = memoria_reservar(cant_bloques * TAM_BLOQUE_FILTRO, hash->paginas_grandes);
+    if (!bloques) return false;
+    memoria_liberar(filtro->bloques, filtro->cant_bloques * TAM_BLOQUE_FILTRO);
+    filtro->bloques = bloques;
+    filtro->cant_bloques = cant_bloques;
+    filtro->borrados = 0;
+
+    for (size_t i = 0; i < hash->capacidad; i++){
+        lista_t* lista = lista_en(hash->segmentos, i);
+        if (!lista) continue;
+        lista_iter_t iter;
+        lista_iter_inicializar(&iter, lista);
+        while (!lista_iter_al_final(&iter)){
+            filtro_agregar(filtro, ((campo_t*)lista_iter_ver_actual(&iter))->hash);
+            lista_iter_avanzar(&iter);
+        }
+    }
+    return true;
+}
+
+/* Cuenta una clave borrada, reconstruyendo el filtro si hay demasiadas */
+void filtro_quitar(hash_t* hash){
+    if (!hash->filtro) return;
+    hash->filtro->borrados++;
+    if (hash->filtro->borrados > hash->cantidad + TAM_INICIAL) reconstruir_filtro(hash, hash->capacidad);
+}
+
+/* Determina si la clave de hash h puede estar, según el filtro */
+bool filtro_consultar(const hash_t* hash, size_t h){
+    filtro_t* filtro = hash->filtro;
+    if (!filtro) return true;
+    atomic_fetch_add_explicit(&filtro->consultas, 1, memory_order_relaxed);
+    if (filtro_puede_estar(filtro, h)) return true;
+    atomic_fetch_add_explicit(&filtro->descartes, 1, memory_order_relaxed);
+    return false;
+}
+
+/* Cuenta una búsqueda que el filtro no descartó y no encontró la clave */
+void filtro_contar_falso_positivo(const hash_t* hash){
+    if (hash->filtro) atomic_fetch_add_explicit(&hash->filtro->falsos_positivos, 1, memory_order_relaxed);
+}
+
+/* Índice ordenado
+ * Es un árbol B con los campos del hash ordenados por clave, así los
+ * iteradores ordenados tienen a mano el hash y el dato de cada clave. Para
+ * buscar una clave se usa un campo que sólo tiene la clave. Las claves
+ * congeladas guardadas se comparan sin decodificarlas, por lo que las
+ * búsquedas desde un hash const no escriben en él. Sólo la buscada se
+ * decodifica en clave_indice si está congelada, lo que pasa únicamente al
+ * modificar el índice. */
+
+int comparar_con_indice(const void* buscado, const void* guardado, void* extra){
+    const hash_t* hash = extra;
+    const char* buscada = ((const campo_t*)buscado)->clave;
+    const char* guardada = ((const campo_t*)guardado)->clave;
+    // Una copia de un campo tiene la misma clave que el original
+    if (buscada == guardada) return 0;
+    if (es_congelada(hash, buscada)){
+        decodificar_clave(buscada, hash->clave_indice);
+        buscada = hash->clave_indice;
+    }
+    if (es_congelada(hash, guardada)) return comparar_congelada(buscada, guardada);
+    return strcmp(buscada, guardada);
+}
+
+void indice_quitar(hash_t* hash, const campo_t* campo){
+    if (!hash->indice) return;
+    campo_t buscado = {.clave = campo->clave};
+    if (es_congelada(hash, buscado.clave)){
+        decodificar_clave(buscado.clave, hash->clave_indice);
+        buscado.clave = hash->clave_indice;
+    }
+    arbol_borrar(hash->indice, &buscado);
+}
+
+/* Deja el iterador sobre el campo de la clave, o al final si no está.
+ * Sólo se comparan las claves cuyo hash completo coincide */
+void iter_buscar_clave(lista_iter_t* iter, const hash_t* hash, lista_t* lista, const char* clave, size_t h){
+    lista_iter_inicializar(iter, lista);
 
     while (!lista_iter_al_final(iter)){
-        char* clave_act = ((campo_t*)lista_iter_ver_actual(iter))->clave;
-        if (!strcmp(clave_act, clave)) break;
+        campo_t* campo = lista_iter_ver_actual(iter);
+        if (campo->hash == h && claves_iguales(hash, campo->clave, clave)) break;
         lista_iter_avanzar(iter);
     }
-
-    return iter;
 }
 
-campo_t* buscar_campo(const hash_t* hash, const char* clave){
-    size_t i = f_hash(hash->capacidad, clave);
+/* Busca un campo no vencido entre los segmentos de un hash o una instantánea */
+campo_t* buscar_en_segmentos(const hash_t* hash, segmento_t** segmentos, size_t capacidad, size_t ahora, const char* clave, size_t h){
+    lista_t* lista = lista_en(segmentos, h % capacidad);
+
+    if (!lista) return NULL;
+
+    lista_iter_t iter_clave;
+    iter_buscar_clave(&iter_clave, hash, lista, clave, h);
+    campo_t* campo = lista_iter_ver_actual(&iter_clave);
+
+    if (campo && campo_vencido(campo, ahora)) return NULL;
 
-    if (!hash->cantidad || !hash->listas[i]) return NULL;
+    return campo;
+}
 
-    lista_iter_t* iter_clave = iter_buscar_clave(hash->listas[i], clave); 
-    if (!iter_clave) return NULL;
-    campo_t* campo = (campo_t*)lista_iter_ver_actual(iter_clave);
-    lista_iter_destruir(iter_clave);
+campo_t* buscar_campo(const hash_t* hash, const char* clave, size_t h){
+    if (!hash->cantidad || !filtro_consultar(hash, h)) return NULL;
 
+    campo_t* campo = buscar_en_segmentos(hash, hash->segmentos, hash->capacidad, hash->ahora, clave, h);
+    if (!campo) filtro_contar_falso_positivo(hash);
     return campo;
 }
 
-/* Función que destruye un arreglo de listas enlazadas
- * Si el 2do parámetro es 0, solo destruye las listas. 
- * Si es 1, también destruye las claves y campos. */
-void destruir_listas(hash_t* hash, int destruccion_campos){
+/* Función que destruye las listas y los segmentos del hash, que no deben
+ * estar compartidos, sin destruir los campos. */
+void destruir_listas(hash_t* hash){
     for (size_t i = 0; i < hash->capacidad; i++){
-        lista_t* lista = hash->listas[i];
-        while (destruccion_campos && lista && !lista_esta_vacia(lista)){
-            campo_t* campo = lista_borrar_primero(lista);
-            if (hash->hash_destruir_dato_t) hash->hash_destruir_dato_t(campo->valor);
-            free(campo->clave); free(campo);
-        }
+        lista_t* lista = lista_en(hash->segmentos, i);
         if(lista) lista_destruir(lista, NULL);
     }
-    free(hash->listas);
+    for (size_t s = 0; s < cant_segmentos(hash->capacidad); s++) liberar_segmento(hash->segmentos[s]);
+    liberar_directorio(hash->segmentos);
 }
 
+/* Primero crea todas las listas nuevas que hacen falta, y recién entonces
+ * mueve los nodos de las listas viejas, lo que no pide memoria porque las
+ * listas del hash guardan un dato por nodo. Los segmentos compartidos se
+ * copian antes, para no modificarlos. */
 bool redimensionar(hash_t* hash, size_t capacidad_nueva){
-    lista_t** datos_nuevos = calloc(capacidad_nueva, sizeof(lista_t*));
+    for (size_t s = 0; s < cant_segmentos(hash->capacidad); s++){
+        if (!hacer_propio(hash, s)) return false;
+    }
+    segmento_t** datos_nuevos = crear_segmentos(capacidad_nueva, hash->paginas_grandes);
     if (!datos_nuevos) return false;
     for (size_t i = 0; i < hash->capacidad; i++){
-        if (!hash->listas[i]) continue;
-        lista_iter_t* lista_iter = lista_iter_crear(hash->listas[i]);
-        while (!lista_iter_al_final(lista_iter)){
-            campo_t* campo = lista_iter_ver_actual(lista_iter);
-            size_t j = f_hash(capacidad_nueva, campo->clave);
-            if (!datos_nuevos[j]) datos_nuevos[j] = lista_crear();
-            if (!datos_nuevos[j] || !lista_insertar_ultimo(datos_nuevos[j], campo)){
-                free(datos_nuevos);
-                lista_iter_destruir(lista_iter);
+        if (!lista_en(hash->segmentos, i)) continue;
+        lista_iter_t lista_iter;
+        lista_iter_inicializar(&lista_iter, lista_en(hash->segmentos, i));
+        while (!lista_iter_al_final(&lista_iter)){
+            campo_t* campo = lista_iter_ver_actual(&lista_iter);
+            size_t j = campo->hash % capacidad_nueva;
+            lista_t** lista_nueva = &datos_nuevos[j / TAM_SEGMENTO]->listas[j % TAM_SEGMENTO];
+            if (!*lista_nueva) *lista_nueva = lista_crear();
+            if (!*lista_nueva){
+                for (size_t s = 0; s < cant_segmentos(capacidad_nueva); s++) soltar_segmento(datos_nuevos[s]);
+                liberar_directorio(datos_nuevos);
                 return false;
             }
-            lista_iter_avanzar(lista_iter);
+            lista_iter_avanzar(&lista_iter);
+        }
+    }
+    for (size_t i = 0; i < hash->capacidad; i++){
+        lista_t* lista = lista_en(hash->segmentos, i);
+        while (lista && !lista_esta_vacia(lista)){
+            campo_t* campo = lista_ver_primero(lista);
+            lista_mover_primero(lista, lista_en(datos_nuevos, campo->hash % capacidad_nueva));
         }
-        lista_iter_destruir(lista_iter);
     }
-    destruir_listas(hash, 0);
+    destruir_listas(hash);
     hash->capacidad = capacidad_nueva;
-    hash->listas = datos_nuevos;
+    hash->segmentos = datos_nuevos;
+    hash->generacion++;
+    if (hash->filtro) reconstruir_filtro(hash, capacidad_nueva);
     return true;
 }
 
-campo_t* generar_campo(const char* clave, void* dato){
+/* Devuelve la clave que guarda el hash para la dada: una copia propia, o la
+ * internada si el hash tiene internador. Devuelve NULL si no hubo memoria. */
+char* copiar_clave(const hash_t* hash, const char* clave){
+    if (hash->internador) return (char*)hash_internar(hash->internador, clave, NULL);
+    return strdup(clave);
+}
+
+// Libera una clave de copiar_clave
+void soltar_copia(const hash_t* hash, char* clave){
+    if (!hash->internador) free(clave);
+}
+
+campo_t* generar_campo(const hash_t* hash, const char* clave, size_t h, void* dato){
     campo_t* campo = malloc(sizeof(campo_t));
-    char* _clave = strdup(clave);
+    char* _clave = campo ? copiar_clave(hash, clave) : NULL;
     if (!campo || !_clave){
-        free(campo); free(_clave);
+        free(campo);
         return NULL;
     }
     campo->clave = _clave;
     campo->valor = dato;
+    campo->hash = h;
+    campo->ficha = NULL;
     return campo;
 }
 
-bool hash_guardar(hash_t *hash, const char *clave, void *dato){
-    if (hash->cantidad >= (hash->capacidad * FACTOR_CARGA_AMPLIACION)){
-        if (!redimensionar(hash, hash->capacidad * CRIT_AGRANDAR)) return false;
-    }
-    size_t i = f_hash(hash->capacidad, clave);
-    if (!hash->listas[i]) hash->listas[i] = lista_crear();
-    if (!hash->listas[i]) return false;
-    lista_iter_t* iterador = iter_buscar_clave(hash->listas[i], clave);
-    if (!iterador) return false;
-    if (!lista_iter_al_final(iterador)){
-        campo_t* campo = lista_iter_ver_actual(iterador);
-        if (hash->hash_destruir_dato_t) hash->hash_destruir_dato_t(campo->valor);
-        campo->valor = dato;
+/* Memoria que ocuparía el hash con la capacidad dada: el bloque de
+ * segmentos, el filtro, las claves, y por cada campo el campo y lo que
+ * ocupa en su lista */
+size_t memoria_con_capacidad(const hash_t* hash, size_t capacidad){
+    size_t memoria = tam_bloque_segmentos(capacidad) + hash->memoria_claves + hash->tam_claves;
+    memoria += hash->cantidad * (sizeof(campo_t) + MEMORIA_LISTA_POR_CAMPO);
+    if (hash->filtro) memoria += bloques_filtro(capacidad, hash->filtro->bits_por_clave) * TAM_BLOQUE_FILTRO;
+    return memoria;
+}
+
+/* Determina si el hash, con la capacidad dada, puede ocupar tam bytes más
+ * sin pasar su límite de memoria */
+bool entra_en_limite(const hash_t* hash, size_t capacidad, size_t tam){
+    return !hash->limite_memoria || memoria_con_capacidad(hash, capacidad) + tam <= hash->limite_memoria;
+}
+
+/* Prepara para modificar la lista de la clave, creándola si no existe, y
+ * deja el iterador sobre el campo de la clave, o al final si no está.
+ * Devuelve false si no se pudo pedir memoria. */
+bool buscar_para_escribir(hash_t* hash, const char* clave, size_t h, lista_iter_t* iter){
+    lista_t** lista = lista_escritura(hash, h % hash->capacidad);
+    if (!lista) return false;
+    if (!*lista) *lista = lista_crear();
+    if (!*lista) return false;
+    iter_buscar_clave(iter, hash, *lista, clave, h);
+    return true;
+}
+
+/* Busca el campo de la clave en una única pasada por su lista, creándolo
+ * con valor NULL si no estaba. Un campo vencido se reutiliza como si fuera
+ * nuevo, destruyendo su dato. En insertado se indica si se lo creó.
+ * Devuelve NULL si no se pudo pedir memoria o si el campo nuevo no entra en
+ * el límite de memoria. Si lo que no entra es la capacidad agrandada, el
+ * hash sigue con la que tiene. */
+campo_t* obtener_o_crear_campo(hash_t* hash, const char* clave, size_t h, bool* insertado){
+    liberar_pendientes(hash);
+    lista_iter_t iterador;
+    if (!buscar_para_escribir(hash, clave, h, &iterador)) return NULL;
+    // Sólo se agranda al insertar, para no invalidar iteradores al reemplazar
+    if (lista_iter_al_final(&iterador) && hash->cantidad >= (hash->capacidad * FACTOR_CARGA_AMPLIACION) && entra_en_limite(hash, hash->capacidad * CRIT_AGRANDAR, 0)){
+        if (!redimensionar(hash, hash->capacidad * CRIT_AGRANDAR)) return NULL;
+        if (!buscar_para_escribir(hash, clave, h, &iterador)) return NULL;
+    }
+    campo_t* campo = NULL;
+    if (!lista_iter_al_final(&iterador)){
+        campo = lista_iter_ver_actual(&iterador);
+        *insertado = campo_vencido(campo, hash->ahora);
+        if (*insertado){
+            destruir_dato(hash, campo->valor);
+            campo->valor = NULL;
+            quitar_ficha(campo);
+        }
     }
     else{
-        campo_t* campo = generar_campo(clave, dato);
-        if (!campo){
-            lista_iter_destruir(iterador);
+        size_t copia = hash->internador ? 0 : strlen(clave) + 1;
+        if (!entra_en_limite(hash, hash->capacidad, sizeof(campo_t) + MEMORIA_LISTA_POR_CAMPO + copia)) return NULL;
+        campo = generar_campo(hash, clave, h, NULL);
+        if (campo && !lista_iter_insertar(&iterador, campo)){
+            soltar_copia(hash, campo->clave); free(campo);
+            campo = NULL;
+        }
+        if (campo && hash->indice && !arbol_insertar(hash->indice, campo)){
+            lista_iter_borrar(&iterador);
+            soltar_copia(hash, campo->clave); free(campo);
+            campo = NULL;
+        }
+        if (campo){
+            hash->cantidad++;
+            hash->generacion++;
+            hash->memoria_claves += copia;
+            if (hash->filtro) filtro_agregar(hash->filtro, h);
+        }
+        *insertado = true;
+    }
+    return campo;
+}
+
+bool hash_guardar(hash_t *hash, const char *clave, void *dato){
+    return hash_guardar_con_hash(hash, clave, hash_calcular(clave), dato);
+}
+
+bool hash_guardar_con_hash(hash_t *hash, const char *clave, size_t h, void *dato){
+    bool insertado;
+    campo_t* campo = obtener_o_crear_campo(hash, clave, h, &insertado);
+    if (!campo) return false;
+    if (!insertado) destruir_dato(hash, campo->valor);
+    campo->valor = dato;
+    quitar_ficha(campo);
+    return true;
+}
+
+/* Devuelve la ranura de la rueda donde agregar un campo que vence en el
+ * instante vencimiento, creando su lista si hace falta. Los campos ya
+ * vencidos van a la próxima ranura por procesar. */
+lista_t* ranura_rueda(hash_t* hash, size_t vencimiento){
+    size_t instante = hash->rueda_cursor + (hash->rueda_pendientes ? 1 : 0);
+    if (vencimiento > instante) instante = vencimiento;
+    size_t i = instante % RANURAS_RUEDA;
+    if (!hash->rueda[i]) hash->rueda[i] = lista_crear();
+    return hash->rueda[i];
+}
+
+bool hash_guardar_con_ttl(hash_t *hash, const char *clave, void *dato, size_t ahora, size_t ttl){
+    if (ahora > hash->ahora) hash->ahora = ahora;
+    size_t vencimiento = ahora + ttl < ahora ? (size_t)-1 : ahora + ttl;
+
+    if (!hash->rueda) hash->rueda = calloc(RANURAS_RUEDA, sizeof(lista_t*));
+    if (!hash->rueda) return false;
+    lista_t* ranura = ranura_rueda(hash, vencimiento);
+    if (!ranura) return false;
+
+    size_t h = hash_calcular(clave);
+    bool insertado;
+    campo_t* campo = obtener_o_crear_campo(hash, clave, h, &insertado);
+    if (!campo) return false;
+    // Con instantáneas, el vencimiento se renueva con una ficha nueva
+    ficha_t* ficha = campo->ficha;
+    if (!ficha || atomic_load(&hash->instantaneas)){
+        ficha = malloc(sizeof(ficha_t));
+        if (!ficha || !lista_insertar_ultimo(ranura, ficha)){
+            free(ficha);
+            if (insertado) hash_borrar_con_hash(hash, clave, h);
             return false;
         }
-        lista_iter_insertar(iterador, campo);  
-        hash->cantidad++;  
+        quitar_ficha(campo);
+        ficha->campo = campo;
+        campo->ficha = ficha;
     }
-    lista_iter_destruir(iterador);
+    if (!insertado) destruir_dato(hash, campo->valor);
+    campo->valor = dato;
+    ficha->vencimiento = vencimiento;
     return true;
 }
 
-void *hash_borrar(hash_t *hash, const char *clave){
-    size_t i = f_hash(hash->capacidad, clave);
+/* Quita el campo vencido de la ficha de su lista del hash, sin
+ * redimensionar. Devuelve false si no pudo copiar su segmento o si el campo
+ * no está en la lista que le corresponde. */
+bool quitar_vencido(hash_t* hash, ficha_t* ficha){
+    lista_t** lista = lista_escritura(hash, ficha->campo->hash % hash->capacidad);
+    if (!lista) return false;
+    // Si se copió el segmento, la ficha ya apunta a la copia del campo
+    campo_t* campo = ficha->campo;
+    lista_iter_t iter;
+    lista_iter_inicializar(&iter, *lista);
+    while (!lista_iter_al_final(&iter) && lista_iter_ver_actual(&iter) != campo) lista_iter_avanzar(&iter);
+    if (lista_iter_al_final(&iter)) return false;
+    lista_iter_borrar(&iter);
+    hash->cantidad--;
+    hash->generacion++;
+    destruir_dato(hash, campo->valor);
+    indice_quitar(hash, campo);
+    liberar_campo(hash, campo);
+    filtro_quitar(hash);
+    return true;
+}
 
-    if (!hash->cantidad || !hash->listas[i]) return NULL;
+size_t hash_expirar(hash_t *hash, size_t ahora, size_t presupuesto){
+    if (ahora > hash->ahora) hash->ahora = ahora;
+    if (!hash->rueda) return 0;
+    liberar_pendientes(hash);
 
-    lista_iter_t* iter_clave = iter_buscar_clave(hash->listas[i], clave);
-    if (!iter_clave || lista_iter_al_final(iter_clave)){
-        if (iter_clave) lista_iter_destruir(iter_clave);
-        return NULL;
+    size_t revisados = 0, expirados = 0;
+    while (revisados < presupuesto){
+        if (!hash->rueda_pendientes){
+            if (hash->rueda_cursor > hash->ahora) break;
+            // Más de una vuelta de atraso: alcanza con procesar la última
+            if (hash->ahora - hash->rueda_cursor >= RANURAS_RUEDA){
+                hash->rueda_cursor = hash->ahora - RANURAS_RUEDA + 1;
+            }
+            lista_t* ranura = hash->rueda[hash->rueda_cursor % RANURAS_RUEDA];
+            hash->rueda_pendientes = ranura ? lista_largo(ranura) : 0;
+            if (!hash->rueda_pendientes){
+                hash->rueda_cursor++;
+                continue;
+            }
+        }
+
+        lista_t* ranura = hash->rueda[hash->rueda_cursor % RANURAS_RUEDA];
+        ficha_t* ficha = lista_ver_primero(ranura);
+        hash->rueda_pendientes--;
+        revisados++;
+
+        if (!ficha->campo){
+            liberar_ficha(hash, lista_borrar_primero(ranura));
+        }
+        else if (!campo_vencido(ficha->campo, hash->ahora)){
+            // Vence en otra vuelta, o se le renovó el vencimiento
+            lista_t* destino = ranura_rueda(hash, ficha->vencimiento);
+            lista_mover_primero(ranura, destino ? destino : ranura);
+        }
+        else if (quitar_vencido(hash, ficha)){
+            liberar_ficha(hash, lista_borrar_primero(ranura));
+            expirados++;
+        }
+        else{
+            lista_mover_primero(ranura, ranura);
+        }
+
+        if (!hash->rueda_pendientes) hash->rueda_cursor++;
     }
-    campo_t* campo = (campo_t*)lista_iter_ver_actual(iter_clave);
+    return expirados;
+}
+
+bool hash_obtener_o_insertar(hash_t *hash, const char *clave, void ***dato, bool *insertado){
+    bool _insertado;
+    campo_t* campo = obtener_o_crear_campo(hash, clave, hash_calcular(clave), &_insertado);
+    if (!campo) return false;
+    *dato = &campo->valor;
+    if (insertado) *insertado = _insertado;
+    return true;
+}
+
+bool hash_actualizar(hash_t *hash, const char *clave, hash_actualizar_dato_t actualizar, void *extra){
+    bool insertado;
+    campo_t* campo = obtener_o_crear_campo(hash, clave, hash_calcular(clave), &insertado);
+    if (!campo) return false;
+    campo->valor = actualizar(campo->valor, !insertado, extra);
+    return true;
+}
+
+/* Borra el campo sobre el que está el iterador de lista y devuelve su
+ * valor, o NULL si estaba vencido, en cuyo caso destruye el valor */
+void* borrar_campo(hash_t* hash, lista_iter_t* iter){
+    campo_t* campo = (campo_t*)lista_iter_borrar(iter);
     void* valor = campo->valor;
-    free(campo->clave);
-    free(lista_iter_borrar(iter_clave));
-    lista_iter_destruir(iter_clave);
+    if (campo_vencido(campo, hash->ahora)){
+        destruir_dato(hash, valor);
+        valor = NULL;
+    }
+    indice_quitar(hash, campo);
+    liberar_campo(hash, campo);
     hash->cantidad--;
+    hash->generacion++;
+    filtro_quitar(hash);
+    return valor;
+}
+
+void *hash_borrar(hash_t *hash, const char *clave){
+    return hash_borrar_con_hash(hash, clave, hash_calcular(clave));
+}
+
+void *hash_borrar_con_hash(hash_t *hash, const char *clave, size_t h){
+    size_t i = h % hash->capacidad;
+
+    if (!hash->cantidad || !lista_en(hash->segmentos, i) || !filtro_consultar(hash, h)) return NULL;
+
+    lista_iter_t iter_clave;
+    iter_buscar_clave(&iter_clave, hash, lista_en(hash->segmentos, i), clave, h);
+    if (lista_iter_al_final(&iter_clave)){
+        filtro_contar_falso_positivo(hash);
+        return NULL;
+    }
+    liberar_pendientes(hash);
+    lista_t** lista = lista_escritura(hash, i);
+    if (!lista) return NULL;
+    // Si se copió el segmento, el iterador quedó sobre la lista vieja
+    iter_buscar_clave(&iter_clave, hash, *lista, clave, h);
+    void* valor = borrar_campo(hash, &iter_clave);
 
     if (hash->cantidad <= (hash->capacidad/FACTOR_CARGA_REDUCCION) && hash->cantidad > TAM_INICIAL){
         redimensionar(hash, hash->capacidad/CRIT_ACHICAR);
@@ -194,7 +986,11 @@ void *hash_borrar(hash_t *hash, const char *clave){
 }
 
 void *hash_obtener(const hash_t *hash, const char *clave){
-    campo_t* campo = buscar_campo(hash, clave);
+    return hash_obtener_con_hash(hash, clave, hash_calcular(clave));
+}
+
+void *hash_obtener_con_hash(const hash_t *hash, const char *clave, size_t h){
+    campo_t* campo = buscar_campo(hash, clave, h);
 
     if (!campo) return NULL;
 
@@ -202,83 +998,852 @@ void *hash_obtener(const hash_t *hash, const char *clave){
 }
 
 bool hash_pertenece(const hash_t *hash, const char *clave){
-    campo_t* campo = buscar_campo(hash, clave);
+    return hash_pertenece_con_hash(hash, clave, hash_calcular(clave));
+}
+
+bool hash_pertenece_con_hash(const hash_t *hash, const char *clave, size_t h){
+    campo_t* campo = buscar_campo(hash, clave, h);
 
     if (!campo) return false;
 
     return true;
 }
 
+const char *hash_obtener_clave(const hash_t *hash, const char *clave){
+    campo_t* campo = buscar_campo(hash, clave, hash_calcular(clave));
+
+    if (!campo) return NULL;
+
+    if (es_congelada(hash, campo->clave)){
+        decodificar_clave(campo->clave, hash->clave_obtenida);
+        return hash->clave_obtenida;
+    }
+    return campo->clave;
+}
+
 size_t hash_cantidad(const hash_t *hash){
     return hash->cantidad;
 }
 
-void hash_destruir(hash_t *hash){
-    destruir_listas(hash, 1);
+void hash_usar_paginas_grandes(hash_t *hash, bool usar){
+    hash->paginas_grandes = usar;
+}
+
+void hash_limitar_memoria(hash_t *hash, size_t limite){
+    hash->limite_memoria = limite;
+}
+
+size_t hash_memoria(const hash_t *hash){
+    return memoria_con_capacidad(hash, hash->capacidad);
+}
+
+bool hash_usar_internador(hash_t *hash, hash_internador_t *internador){
+    if (hash->cantidad) return false;
+    hash->internador = internador;
+    return true;
+}
+
+bool hash_filtro_activar(hash_t *hash, size_t bits_por_clave){
+    if (!bits_por_clave){
+        if (hash->filtro) memoria_liberar(hash->filtro->bloques, hash->filtro->cant_bloques * TAM_BLOQUE_FILTRO);
+        free(hash->filtro);
+        hash->filtro = NULL;
+        return true;
+    }
+    size_t anterior_tam = hash->filtro ? hash->filtro->cant_bloques * TAM_BLOQUE_FILTRO : 0;
+    size_t tam = bloques_filtro(hash->capacidad, bits_por_clave) * TAM_BLOQUE_FILTRO;
+    if (hash->limite_memoria && hash_memoria(hash) - anterior_tam + tam > hash->limite_memoria) return false;
+    filtro_t* filtro = calloc(1, sizeof(filtro_t));
+    if (!filtro) return false;
+    filtro_t* anterior = hash->filtro;
+    filtro->bits_por_clave = bits_por_clave;
+    atomic_init(&filtro->consultas, 0);
+    atomic_init(&filtro->descartes, 0);
+    atomic_init(&filtro->falsos_positivos, 0);
+    hash->filtro = filtro;
+    if (!reconstruir_filtro(hash, hash->capacidad)){
+        free(filtro);
+        hash->filtro = anterior;
+        return false;
+    }
+    if (anterior) memoria_liberar(anterior->bloques, anterior_tam);
+    free(anterior);
+    return true;
+}
+
+bool hash_indice_activar(hash_t *hash){
+    if (hash->indice) return true;
+    arbol_t* indice = arbol_crear(comparar_con_indice, hash);
+    char* clave_indice = hash->claves ? malloc(hash->largo_maximo + 1) : NULL;
+    bool ok = indice && (!hash->claves || clave_indice);
+    hash->clave_indice = clave_indice;
+    for (size_t i = 0; ok && i < hash->capacidad; i++){
+        lista_t* lista = lista_en(hash->segmentos, i);
+        if (!lista) continue;
+        lista_iter_t iter;
+        lista_iter_inicializar(&iter, lista);
+        while (ok && !lista_iter_al_final(&iter)){
+            ok = arbol_insertar(indice, lista_iter_ver_actual(&iter));
+            lista_iter_avanzar(&iter);
+        }
+    }
+    if (!ok){
+        if (indice) arbol_destruir(indice);
+        free(clave_indice);
+        hash->clave_indice = NULL;
+        return false;
+    }
+    hash->indice = indice;
+    return true;
+}
+
+void hash_indice_desactivar(hash_t *hash){
+    if (hash->indice) arbol_destruir(hash->indice);
+    free(hash->clave_indice);
+    hash->indice = NULL;
+    hash->clave_indice = NULL;
+}
+
+size_t hash_filtro_consultas(const hash_t *hash){
+    return hash->filtro ? atomic_load_explicit(&hash->filtro->consultas, memory_order_relaxed) : 0;
+}
+
+size_t hash_filtro_descartes(const hash_t *hash){
+    return hash->filtro ? atomic_load_explicit(&hash->filtro->descartes, memory_order_relaxed) : 0;
+}
+
+size_t hash_filtro_falsos_positivos(const hash_t *hash){
+    return hash->filtro ? atomic_load_explicit(&hash->filtro->falsos_positivos, memory_order_relaxed) : 0;
+}
+
+/* Reemplaza las claves congeladas por copias propias, para poder volver a
+ * congelarlas junto con las demás. Si falla, las que ya se reemplazaron
+ * siguen siendo válidas, y se cuentan en memoria_claves como las demás
+ * copias propias. */
+bool descongelar_claves(hash_t* hash, campo_t** campos){
+    for (size_t i = 0; i < hash->cantidad; i++){
+        if (!es_congelada(hash, campos[i]->clave)) continue;
+        char* clave = malloc(hash->largo_maximo + 1);
+        if (!clave) return false;
+        decodificar_clave(campos[i]->clave, clave);
+        campos[i]->clave = clave;
+        hash->memoria_claves += strlen(clave) + 1;
+    }
+    return true;
+}
+
+int comparar_campos(const void* a, const void* b){
+    return strcmp((*(campo_t* const*)a)->clave, (*(campo_t* const*)b)->clave);
+}
+
+/* Codifica las claves de los campos, ya ordenadas, y guarda en posiciones
+ * dónde empieza cada una. Devuelve el tamaño de la codificación. */
+size_t codificar_claves(campo_t** campos, size_t cantidad, unsigned char* destino, size_t* posiciones){
+    unsigned char* p = destino;
+    size_t inicio = 0;
+    for (size_t i = 0; i < cantidad; i++){
+        const char* clave = campos[i]->clave;
+        size_t compartido = 0;
+        if (i % CLAVES_POR_BLOQUE == 0){
+            inicio = (size_t)(p - destino);
+        }
+        else{
+            const char* anterior = campos[i - 1]->clave;
+            while (clave[compartido] && clave[compartido] == anterior[compartido]) compartido++;
+        }
+        size_t largo = strlen(clave + compartido);
+        posiciones[i] = (size_t)(p - destino);
+        p = escribir_varint(p, posiciones[i] - inicio);
+        p = escribir_varint(p, compartido);
+        p = escribir_varint(p, largo);
+        memcpy(p, clave + compartido, largo);
+        p += largo;
+    }
+    return (size_t)(p - destino);
+}
+
+bool hash_congelar_claves(hash_t *hash){
+    if (atomic_load(&hash->instantaneas) || hash->internador) return false;
+    liberar_pendientes(hash);
+
+    campo_t** campos = malloc((hash->cantidad + 1) * sizeof(campo_t*));
+    size_t* posiciones = malloc((hash->cantidad + 1) * sizeof(size_t));
+    if (!campos || !posiciones){
+        free(campos); free(posiciones);
+        return false;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < hash->capacidad; i++){
+        lista_t* lista = lista_en(hash->segmentos, i);
+        if (!lista) continue;
+        lista_iter_t iter;
+        lista_iter_inicializar(&iter, lista);
+        while (!lista_iter_al_final(&iter)){
+            campos[n++] = lista_iter_ver_actual(&iter);
+            lista_iter_avanzar(&iter);
+        }
+    }
+
+    bool ok = descongelar_claves(hash, campos);
+    size_t cota = 0, largo_maximo = 0;
+    for (size_t i = 0; ok && i < n; i++){
+        size_t largo = strlen(campos[i]->clave);
+        if (largo > largo_maximo) largo_maximo = largo;
+        cota += largo + 3 * MAX_VARINT;
+    }
+    unsigned char* claves = ok ? malloc(cota + 1) : NULL;
+    char* clave_obtenida = claves ? malloc(largo_maximo + 1) : NULL;
+    char* clave_indice = clave_obtenida && hash->indice ? malloc(largo_maximo + 1) : NULL;
+    if (!clave_obtenida || (hash->indice && !clave_indice)){
+        free(claves); free(clave_obtenida); free(campos); free(posiciones);
+        return false;
+    }
+
+    qsort(campos, n, sizeof(campo_t*), comparar_campos);
+    size_t tam = codificar_claves(campos, n, claves, posiciones);
+    unsigned char* achicadas = realloc(claves, tam + 1);
+    if (achicadas) claves = achicadas;
+
+    // El índice guarda los campos, que siguen siendo los mismos
+    if (clave_indice){
+        free(hash->clave_indice);
+        hash->clave_indice = clave_indice;
+    }
+
+    for (size_t i = 0; i < n; i++){
+        free(campos[i]->clave);
+        campos[i]->clave = (char*)claves + posiciones[i];
+    }
+    free(hash->claves);
+    free(hash->clave_obtenida);
+    hash->claves = claves;
+    hash->tam_claves = tam;
+    hash->memoria_claves = 0;
+    hash->largo_maximo = largo_maximo;
+    hash->clave_obtenida = clave_obtenida;
+    hash->generacion++;
+    free(campos); free(posiciones);
+    return true;
+}
+
+/* Fusión y diferencia
+ * La fusión mueve los nodos de las listas de origen a las de destino con
+ * lista_mover_primero, por lo que no pide memoria para los campos ni para
+ * las claves, salvo las congeladas en origen, que no pueden moverse. El
+ * índice y el filtro de origen se rehacen una sola vez al terminar. */
+
+/* Da al campo una ficha en la rueda del hash para que venza en el instante
+ * vencimiento. Devuelve false si no hubo memoria. */
+bool agregar_a_rueda(hash_t* hash, campo_t* campo, size_t vencimiento){
+    if (!hash->rueda) hash->rueda = calloc(RANURAS_RUEDA, sizeof(lista_t*));
+    if (!hash->rueda) return false;
+    lista_t* ranura = ranura_rueda(hash, vencimiento);
+    ficha_t* ficha = ranura ? malloc(sizeof(ficha_t)) : NULL;
+    if (!ficha || !lista_insertar_ultimo(ranura, ficha)){
+        free(ficha);
+        return false;
+    }
+    ficha->campo = campo;
+    ficha->vencimiento = vencimiento;
+    campo->ficha = ficha;
+    return true;
+}
+
+/* Quita el primer campo de la lista de origen sin pasarlo a destino */
+void descartar_primero(hash_t* origen, lista_t* lista, bool destruir){
+    campo_t* campo = lista_borrar_primero(lista);
+    if (destruir) destruir_dato(origen, campo->valor);
+    liberar_campo(origen, campo);
+    origen->cantidad--;
+}
+
+/* Pasa el dato y el vencimiento del primer campo de la lista de origen al
+ * campo existente de destino, y descarta el de origen */
+bool reemplazar_con_primero(hash_t* destino, hash_t* origen, lista_t* lista, campo_t* existente){
+    campo_t* campo = lista_ver_primero(lista);
+    ficha_t* ficha = existente->ficha;
+    existente->ficha = NULL;
+    if (campo->ficha && !agregar_a_rueda(destino, existente, campo->ficha->vencimiento)){
+        existente->ficha = ficha;
+        return false;
+    }
+    if (ficha) ficha->campo = NULL;
+    destruir_dato(destino, existente->valor);
+    existente->valor = campo->valor;
+    descartar_primero(origen, lista, false);
+    destino->generacion++;
+    return true;
+}
+
+/* Mueve el primer campo de la lista de origen a destino, o lo descarta si
+ * está vencido o si su clave está en destino y se conserva la de destino.
+ * clave es un buffer para decodificar las claves congeladas de origen. */
+bool fusionar_primero(hash_t* destino, hash_t* origen, lista_t* lista, hash_politica_t politica, char* clave){
+    campo_t* campo = lista_ver_primero(lista);
+    if (campo_vencido(campo, origen->ahora)){
+        descartar_primero(origen, lista, true);
+        return true;
+    }
+    bool congelada = es_congelada(origen, campo->clave);
+    if (congelada) decodificar_clave(campo->clave, clave);
+    else clave = campo->clave;
+
+    lista_t** lista_destino = lista_escritura(destino, campo->hash % destino->capacidad);
+    if (!lista_destino) return false;
+    if (!*lista_destino) *lista_destino = lista_crear();
+    if (!*lista_destino) return false;
+    lista_iter_t iter;
+    iter_buscar_clave(&iter, destino, *lista_destino, clave, campo->hash);
+    campo_t* existente = lista_iter_ver_actual(&iter);
+    if (existente && politica == HASH_CONSERVAR_DESTINO && !campo_vencido(existente, destino->ahora)){
+        descartar_primero(origen, lista, true);
+        return true;
+    }
+    if (existente) return reemplazar_con_primero(destino, origen, lista, existente);
+
+    // La clave se mueve si los dos hashes la guardan igual, y si no se copia
+    bool mover = !congelada && origen->internador == destino->internador;
+    size_t largo = strlen(clave) + 1;
+    size_t copia = destino->internador ? 0 : largo;
+    if (!entra_en_limite(destino, destino->capacidad, sizeof(campo_t) + MEMORIA_LISTA_POR_CAMPO + copia)) return false;
+    char* propia = mover ? NULL : copiar_clave(destino, clave);
+    if (!mover && !propia) return false;
+    ficha_t* ficha = campo->ficha;
+    campo->ficha = NULL;
+    if (ficha && !agregar_a_rueda(destino, campo, ficha->vencimiento)){
+        campo->ficha = ficha;
+        if (propia) soltar_copia(destino, propia);
+        return false;
+    }
+    // El campo entra al índice de destino con la clave que guarda destino
+    char* clave_origen = campo->clave;
+    if (propia) campo->clave = propia;
+    if (destino->indice && !arbol_insertar(destino->indice, campo)){
+        campo->clave = clave_origen;
+        quitar_ficha(campo);
+        campo->ficha = ficha;
+        if (propia) soltar_copia(destino, propia);
+        return false;
+    }
+    if (ficha) ficha->campo = NULL;
+    if (!congelada && !origen->internador) origen->memoria_claves -= largo;
+    if (propia && !congelada) soltar_copia(origen, clave_origen);
+    lista_mover_primero(lista, *lista_destino);
+    origen->cantidad--;
+    destino->cantidad++;
+    destino->memoria_claves += copia;
+    destino->generacion++;
+    if (destino->filtro) filtro_agregar(destino->filtro, campo->hash);
+    return true;
+}
+
+bool hash_fusionar(hash_t *destino, hash_t *origen, hash_politica_t politica){
+    if (destino == origen) return true;
+    if (atomic_load(&origen->instantaneas)) return false;
+    liberar_pendientes(destino);
+
+    // destino se agranda una única vez, suponiendo que no hay claves repetidas
+    size_t capacidad = destino->capacidad;
+    while (destino->cantidad + origen->cantidad >= capacidad * FACTOR_CARGA_AMPLIACION){
+        capacidad *= CRIT_AGRANDAR;
+    }
+    if (capacidad != destino->capacidad && entra_en_limite(destino, capacidad, 0) && !redimensionar(destino, capacidad)) return false;
+    char* clave = origen->claves ? malloc(origen->largo_maximo + 1) : NULL;
+    if (origen->claves && !clave) return false;
+
+    bool con_indice = origen->indice != NULL;
+    hash_indice_desactivar(origen);
+    bool ok = true;
+    for (size_t i = 0; ok && i < origen->capacidad; i++){
+        lista_t* lista = lista_en(origen->segmentos, i);
+        while (ok && lista && !lista_esta_vacia(lista)){
+            ok = fusionar_primero(destino, origen, lista, politica, clave);
+        }
+    }
+    free(clave);
+    origen->generacion++;
+
+    if (!origen->cantidad && origen->capacidad > TAM_INICIAL){
+        redimensionar(origen, TAM_INICIAL);
+    }
+    else if (origen->filtro){
+        reconstruir_filtro(origen, origen->capacidad);
+    }
+    if (con_indice && !hash_indice_activar(origen)) ok = false;
+    return ok;
+}
+
+/* Parte del recorrido de hash_diferencia a cargo de un hilo: la misma
+ * fracción de las listas de cada hash. clave es su buffer para decodificar
+ * las claves congeladas. */
+typedef struct diferencia{
+    const hash_t* viejo;
+    const hash_t* nuevo;
+    bool (*iguales)(const void*, const void*);
+    bool (*visitar)(const char*, hash_cambio_t, void*, void*, void*);
+    void* extra;
+    size_t parte;
+    size_t partes;
+    char* clave;
+    atomic_bool* detenida;
+    pthread_t hilo;
+    bool lanzada;
+} diferencia_t;
+
+/* Busca como buscar_campo, pero sin contar la consulta en el filtro, para
+ * poder llamarla desde varios hilos a la vez */
+campo_t* buscar_campo_compartido(const hash_t* hash, const char* clave, size_t h){
+    if (!hash->cantidad || (hash->filtro && !filtro_puede_estar(hash->filtro, h))) return NULL;
+    return buscar_en_segmentos(hash, hash->segmentos, hash->capacidad, hash->ahora, clave, h);
+}
+
+/* Recorre la parte de las listas de recorrido buscando cada clave en otro.
+ * Si recorrido es el hash viejo informa las claves quitadas y cambiadas, y
+ * si no, las agregadas. */
+void recorrer_diferencia(diferencia_t* dif, const hash_t* recorrido, const hash_t* otro){
+    bool es_viejo = recorrido == dif->viejo;
+    size_t inicio = recorrido->capacidad * dif->parte / dif->partes;
+    size_t fin = recorrido->capacidad * (dif->parte + 1) / dif->partes;
+    for (size_t i = inicio; i < fin && !atomic_load(dif->detenida); i++){
+        lista_t* lista = lista_en(recorrido->segmentos, i);
+        if (!lista) continue;
+        lista_iter_t iter;
+        lista_iter_inicializar(&iter, lista);
+        for (; !lista_iter_al_final(&iter); lista_iter_avanzar(&iter)){
+            campo_t* campo = lista_iter_ver_actual(&iter);
+            if (campo_vencido(campo, recorrido->ahora)) continue;
+            const char* clave = campo->clave;
+            if (es_congelada(recorrido, clave)){
+                decodificar_clave(clave, dif->clave);
+                clave = dif->clave;
+            }
+            campo_t* par = buscar_campo_compartido(otro, clave, campo->hash);
+            bool seguir = true;
+            if (!par && es_viejo){
+                seguir = dif->visitar(clave, HASH_QUITADA, campo->valor, NULL, dif->extra);
+            }
+            else if (!par){
+                seguir = dif->visitar(clave, HASH_AGREGADA, NULL, campo->valor, dif->extra);
+            }
+            else if (es_viejo && (dif->iguales ? !dif->iguales(campo->valor, par->valor) : campo->valor != par->valor)){
+                seguir = dif->visitar(clave, HASH_CAMBIADA, campo->valor, par->valor, dif->extra);
+            }
+            if (!seguir){
+                atomic_store(dif->detenida, true);
+                return;
+            }
+        }
+    }
+}
+
+void* recorrer_parte(void* arg){
+    diferencia_t* dif = arg;
+    recorrer_diferencia(dif, dif->viejo, dif->nuevo);
+    recorrer_diferencia(dif, dif->nuevo, dif->viejo);
+    return NULL;
+}
+
+bool hash_diferencia(const hash_t *viejo, const hash_t *nuevo, bool iguales(const void *dato_viejo, const void *dato_nuevo), bool visitar(const char *clave, hash_cambio_t cambio, void *dato_viejo, void *dato_nuevo, void *extra), void *extra, size_t hilos){
+    if (!hilos) hilos = 1;
+    diferencia_t* partes = calloc(hilos, sizeof(diferencia_t));
+    if (!partes) return false;
+    size_t largo = (viejo->largo_maximo > nuevo->largo_maximo ? viejo->largo_maximo : nuevo->largo_maximo) + 1;
+    bool congeladas = viejo->claves || nuevo->claves;
+    atomic_bool detenida;
+    atomic_init(&detenida, false);
+
+    bool ok = true;
+    for (size_t k = 0; k < hilos; k++){
+        partes[k] = (diferencia_t){.viejo = viejo, .nuevo = nuevo, .iguales = iguales, .visitar = visitar,
+                                   .extra = extra, .parte = k, .partes = hilos, .detenida = &detenida};
+        partes[k].clave = congeladas ? malloc(largo) : NULL;
+        if (congeladas && !partes[k].clave) ok = false;
+    }
+    // La parte 0 la recorre este hilo, igual que las que no se pudo lanzar
+    for (size_t k = 1; ok && k < hilos; k++){
+        partes[k].lanzada = !pthread_create(&partes[k].hilo, NULL, recorrer_parte, &partes[k]);
+    }
+    for (size_t k = 0; ok && k < hilos; k++){
+        if (!partes[k].lanzada) recorrer_parte(&partes[k]);
+    }
+    for (size_t k = 0; k < hilos; k++){
+        if (partes[k].lanzada) pthread_join(partes[k].hilo, NULL);
+        free(partes[k].clave);
+    }
+    free(partes);
+    return ok;
+}
+
+/* Al destruir el hash por partes, destruccion es la próxima posición a
+ * liberar: las menores a la capacidad son las listas del hash, y las
+ * siguientes las ranuras de la rueda. Cada campo, ficha o posición consume
+ * una unidad del presupuesto. */
+/* Libera las claves y datos pendientes y sus listas, descontando cada uno
+ * de presupuesto. Devuelve false si no le alcanzó el presupuesto. */
+bool destruir_pendientes(hash_t* hash, size_t* presupuesto){
+    while (!lista_esta_vacia(hash->claves_pendientes)){
+        if (!(*presupuesto)--) return false;
+        free(lista_borrar_primero(hash->claves_pendientes));
+    }
+    while (!lista_esta_vacia(hash->datos_pendientes)){
+        if (!(*presupuesto)--) return false;
+        hash->hash_destruir_dato_t(lista_borrar_primero(hash->datos_pendientes));
+    }
+    lista_destruir(hash->claves_pendientes, NULL);
+    lista_destruir(hash->datos_pendientes, NULL);
+    hash->claves_pendientes = NULL;
+    hash->datos_pendientes = NULL;
+    return true;
+}
+
+bool hash_destruir_por_partes(hash_t *hash, size_t presupuesto){
+    if (!hash->destruyendo){
+        hash_filtro_activar(hash, 0);
+        hash->destruyendo = true;
+        hash->destruccion = 0;
+    }
+
+    // Las claves del índice son las de los campos: sólo se liberan sus nodos
+    if (hash->claves_pendientes && !destruir_pendientes(hash, &presupuesto)) return false;
+    if (hash->indice){
+        if (!arbol_destruir_por_partes(hash->indice, &presupuesto)) return false;
+        hash->indice = NULL;
+        free(hash->clave_indice);
+        hash->clave_indice = NULL;
+    }
+
+    for (; hash->destruccion < hash->capacidad; hash->destruccion++){
+        size_t i = hash->destruccion;
+        lista_t* lista = lista_en(hash->segmentos, i);
+        while (lista && !lista_esta_vacia(lista)){
+            if (!presupuesto--) return false;
+            campo_t* campo = lista_borrar_primero(lista);
+            if (hash->hash_destruir_dato_t) hash->hash_destruir_dato_t(campo->valor);
+            if (!es_congelada(hash, campo->clave)) soltar_copia(hash, campo->clave);
+            free(campo);
+        }
+        if (!presupuesto--) return false;
+        if (lista) lista_destruir(lista, NULL);
+        hash->segmentos[i / TAM_SEGMENTO]->listas[i % TAM_SEGMENTO] = NULL;
+        if (i % TAM_SEGMENTO == TAM_SEGMENTO - 1 || i == hash->capacidad - 1){
+            liberar_segmento(hash->segmentos[i / TAM_SEGMENTO]);
+        }
+    }
+
+    for (; hash->rueda && hash->destruccion < hash->capacidad + RANURAS_RUEDA; hash->destruccion++){
+        lista_t** ranura = &hash->rueda[hash->destruccion - hash->capacidad];
+        while (*ranura && !lista_esta_vacia(*ranura)){
+            if (!presupuesto--) return false;
+            free(lista_borrar_primero(*ranura));
+        }
+        if (*ranura) lista_destruir(*ranura, NULL);
+        *ranura = NULL;
+    }
+
+    liberar_directorio(hash->segmentos);
+    free(hash->rueda);
+    free(hash->claves);
+    free(hash->clave_obtenida);
     free(hash);
+    return true;
+}
+
+void hash_destruir(hash_t *hash){
+    hash_destruir_por_partes(hash, SIZE_MAX);
+}
+
+void* destruir_en_segundo_plano(void* hash){
+    hash_destruir(hash);
+    return NULL;
+}
+
+void hash_destruir_diferido(hash_t *hash){
+    pthread_t hilo;
+    if (pthread_create(&hilo, NULL, destruir_en_segundo_plano, hash)){
+        hash_destruir(hash);
+        return;
+    }
+    pthread_detach(hilo);
+}
+
+/* Una instantánea comparte los segmentos del hash al momento de crearla.
+ * Guarda su propio directorio de segmentos, ya que el hash reemplaza los
+ * segmentos que copia y el directorio entero al redimensionar. */
+struct hash_instantanea{
+    hash_t* hash;
+    char* clave;
+    segmento_t** segmentos;
+    size_t capacidad;
+    size_t cantidad;
+    size_t ahora;
+};
+
+hash_instantanea_t *hash_instantanea_crear(hash_t *hash){
+    if (!hash->claves_pendientes){
+        hash->claves_pendientes = lista_crear();
+        hash->datos_pendientes = lista_crear();
+        if (!hash->claves_pendientes || !hash->datos_pendientes){
+            if (hash->claves_pendientes) lista_destruir(hash->claves_pendientes, NULL);
+            if (hash->datos_pendientes) lista_destruir(hash->datos_pendientes, NULL);
+            hash->claves_pendientes = NULL;
+            hash->datos_pendientes = NULL;
+            return NULL;
+        }
+    }
+    liberar_pendientes(hash);
+
+    hash_instantanea_t* inst = malloc(sizeof(hash_instantanea_t));
+    size_t n = cant_segmentos(hash->capacidad);
+    segmento_t** segmentos = malloc(n * sizeof(segmento_t*));
+    // Buffer para decodificar las claves congeladas al iterar
+    char* clave = hash->claves ? malloc(hash->largo_maximo + 1) : NULL;
+    if (!inst || !segmentos || (hash->claves && !clave)){
+        free(inst); free(segmentos); free(clave);
+        return NULL;
+    }
+    for (size_t s = 0; s < n; s++){
+        segmentos[s] = hash->segmentos[s];
+        atomic_fetch_add(&segmentos[s]->referencias, 1);
+    }
+    inst->hash = hash;
+    inst->clave = clave;
+    inst->segmentos = segmentos;
+    inst->capacidad = hash->capacidad;
+    inst->cantidad = hash->cantidad;
+    inst->ahora = hash->ahora;
+    atomic_fetch_add(&hash->instantaneas, 1);
+    return inst;
+}
+
+void *hash_instantanea_obtener(const hash_instantanea_t *inst, const char *clave){
+    campo_t* campo = buscar_en_segmentos(inst->hash, inst->segmentos, inst->capacidad, inst->ahora, clave, hash_calcular(clave));
+
+    if (!campo) return NULL;
+
+    return campo->valor;
+}
+
+bool hash_instantanea_pertenece(const hash_instantanea_t *inst, const char *clave){
+    return buscar_en_segmentos(inst->hash, inst->segmentos, inst->capacidad, inst->ahora, clave, hash_calcular(clave)) != NULL;
+}
+
+size_t hash_instantanea_cantidad(const hash_instantanea_t *inst){
+    return inst->cantidad;
+}
+
+void hash_instantanea_iterar(const hash_instantanea_t *inst, bool visitar(const char *clave, void *dato, void *extra), void *extra){
+    for (size_t i = 0; i < inst->capacidad; i++){
+        lista_t* lista = lista_en(inst->segmentos, i);
+        if (!lista) continue;
+        lista_iter_t iter;
+        lista_iter_inicializar(&iter, lista);
+        while (!lista_iter_al_final(&iter)){
+            campo_t* campo = lista_iter_ver_actual(&iter);
+            const char* clave = campo->clave;
+            if (es_congelada(inst->hash, clave)){
+                decodificar_clave(clave, inst->clave);
+                clave = inst->clave;
+            }
+            if (!campo_vencido(campo, inst->ahora) && !visitar(clave, campo->valor, extra)) return;
+            lista_iter_avanzar(&iter);
+        }
+    }
+}
+
+void hash_instantanea_destruir(hash_instantanea_t *inst){
+    for (size_t s = 0; s < cant_segmentos(inst->capacidad); s++){
+        soltar_segmento(inst->segmentos[s]);
+    }
+    free(inst->segmentos);
+    free(inst->clave);
+    atomic_fetch_sub(&inst->hash->instantaneas, 1);
+    free(inst);
 }
 
+/* El iterador guarda la generación del hash al crearlo; si dejan de
+ * coincidir, el hash se modificó por fuera del iterador.
+ * Los iteradores ordenados recorren el índice con orden en lugar de las
+ * listas, hasta la primera clave que no es menor que limite, o que no
+ * empieza con limite si limite_es_prefijo. */
 struct hash_iter{
     size_t pos;
-    size_t cant_iterados;
-    lista_iter_t* iter_lista;
-    const hash_t* hash;
+    lista_iter_t iter_lista;
+    hash_t* hash;
+    size_t generacion;
+    char* clave;
+    arbol_iter_t* orden;
+    char* limite;
+    bool limite_es_prefijo;
+    bool fuera_de_limite;
 };
 
-hash_iter_t *hash_iter_crear(const hash_t *hash){
+/* Deja el iterador sobre el primer campo desde la lista n en adelante */
+void iter_ir_a_lista(hash_iter_t* iter, size_t n){
+    iter->pos = encontrar_prox_lista(iter->hash, n);
+    if (iter->pos < iter->hash->capacidad){
+        lista_iter_inicializar(&iter->iter_lista, lista_en(iter->hash->segmentos, iter->pos));
+    }
+}
+
+hash_iter_t* crear_iter(const hash_t* hash){
     hash_iter_t* iter = malloc(sizeof(hash_iter_t));
     if (!iter) return NULL;
 
-    if (!hash->cantidad){
-        iter->iter_lista = NULL;
-        iter->pos = hash->capacidad;
+    // Buffer para decodificar las claves congeladas
+    iter->clave = hash->claves ? malloc(hash->largo_maximo + 1) : NULL;
+    if (hash->claves && !iter->clave){
+        free(iter);
+        return NULL;
     }
-    else{
-        size_t i = encontrar_prox_lista(hash, 0);
+    iter->hash = (hash_t*)hash;
+    iter->generacion = hash->generacion;
+    iter->orden = NULL;
+    iter->limite = NULL;
+    iter->limite_es_prefijo = false;
+    iter->fuera_de_limite = false;
+    return iter;
+}
 
-        lista_iter_t* iter_lista = lista_iter_crear(hash->listas[i]);
-        if (!iter_lista){
-            free(iter);
-            return NULL;
-        }
-        iter->iter_lista = iter_lista;
-        iter->pos = i;
-    }
-    iter->cant_iterados = 0;
-    iter->hash = hash;
+hash_iter_t *hash_iter_crear(const hash_t *hash){
+    hash_iter_t* iter = crear_iter(hash);
+    if (!iter) return NULL;
+
+    iter_ir_a_lista(iter, 0);
 
     return iter;
 }
 
-bool hash_iter_avanzar(hash_iter_t *iter){
-    if (hash_iter_al_final(iter)) return false;
-    
-    lista_iter_avanzar(iter->iter_lista);
-    if (lista_iter_al_final(iter->iter_lista) && (iter->cant_iterados+1 != iter->hash->cantidad)){
-        size_t i = encontrar_prox_lista(iter->hash, iter->pos + 1);
+/* Devuelve la clave guardada, decodificándola si está congelada */
+const char* iter_clave_legible(const hash_iter_t* iter, const char* guardada){
+    if (!es_congelada(iter->hash, guardada)) return guardada;
+    decodificar_clave(guardada, iter->clave);
+    return iter->clave;
+}
+
+/* Devuelve el campo sobre el que está el iterador */
+campo_t* iter_campo_actual(const hash_iter_t* iter){
+    if (iter->orden) return arbol_iter_ver_actual(iter->orden);
+    return lista_iter_ver_actual(&iter->iter_lista);
+}
+
+/* Determina si el iterador ordenado pasó su límite */
+void iter_verificar_limite(hash_iter_t* iter){
+    if (!iter->limite || arbol_iter_al_final(iter->orden)) return;
+    const char* clave = iter_clave_legible(iter, iter_campo_actual(iter)->clave);
+    if (iter->limite_es_prefijo) iter->fuera_de_limite = strncmp(clave, iter->limite, strlen(iter->limite)) != 0;
+    else iter->fuera_de_limite = strcmp(clave, iter->limite) >= 0;
+}
+
+hash_iter_t* crear_iter_ordenado(const hash_t* hash, const char* desde, const char* limite, bool limite_es_prefijo){
+    if (!hash->indice) return NULL;
+    hash_iter_t* iter = crear_iter(hash);
+    if (!iter) return NULL;
+    campo_t buscado = {.clave = (char*)desde};
+    iter->orden = arbol_iter_crear(hash->indice, desde ? &buscado : NULL);
+    iter->limite = limite ? strdup(limite) : NULL;
+    if (!iter->orden || (limite && !iter->limite)){
+        hash_iter_destruir(iter);
+        return NULL;
+    }
+    iter->limite_es_prefijo = limite_es_prefijo;
+    iter_verificar_limite(iter);
+    return iter;
+}
 
-        lista_iter_t* iter_lista = lista_iter_crear(iter->hash->listas[i]);
-        if (!iter_lista) return false;
+hash_iter_t *hash_iter_crear_rango(const hash_t *hash, const char *desde, const char *hasta){
+    return crear_iter_ordenado(hash, desde, hasta, false);
+}
 
-        lista_iter_destruir(iter->iter_lista);
-        iter->pos = i;
-        iter->iter_lista = iter_lista;
+hash_iter_t *hash_iter_crear_prefijo(const hash_t *hash, const char *prefijo){
+    return crear_iter_ordenado(hash, prefijo, prefijo, true);
+}
+
+bool hash_iter_avanzar(hash_iter_t *iter){
+    if (hash_iter_al_final(iter)) return false;
+    if (iter->orden){
+        arbol_iter_avanzar(iter->orden);
+        iter_verificar_limite(iter);
+        return true;
     }
-    iter->cant_iterados++;
+    
+    lista_iter_avanzar(&iter->iter_lista);
+    if (lista_iter_al_final(&iter->iter_lista)) iter_ir_a_lista(iter, iter->pos + 1);
     return true;
 }
 
 const char *hash_iter_ver_actual(const hash_iter_t *iter){
     if (hash_iter_al_final(iter)) return NULL; 
-    campo_t* campo =  (campo_t*)lista_iter_ver_actual(iter->iter_lista);
-    return campo->clave;
+    return iter_clave_legible(iter, iter_campo_actual(iter)->clave);
+}
+
+void *hash_iter_ver_dato(const hash_iter_t *iter){
+    if (hash_iter_al_final(iter)) return NULL;
+    return iter_campo_actual(iter)->valor;
+}
+
+size_t hash_iter_ver_hash(const hash_iter_t *iter){
+    return iter_campo_actual(iter)->hash;
 }
 
 bool hash_iter_al_final(const hash_iter_t *iter){
-    return iter->cant_iterados == iter->hash->cantidad;
+    if (hash_iter_invalidado(iter)) return true;
+    if (iter->orden) return arbol_iter_al_final(iter->orden) || iter->fuera_de_limite;
+    return iter->pos >= iter->hash->capacidad;
+}
+
+bool hash_iter_invalidado(const hash_iter_t *iter){
+    return iter->generacion != iter->hash->generacion;
+}
+
+/* Borra la clave actual de un iterador ordenado, y lo ubica en la siguiente */
+void* iter_ordenado_borrar_actual(hash_iter_t* iter){
+    hash_t* hash = iter->hash;
+    char* clave = strdup(hash_iter_ver_actual(iter));
+    if (!clave) return NULL;
+    size_t h = iter_campo_actual(iter)->hash;
+    liberar_pendientes(hash);
+    lista_t** lista = lista_escritura(hash, h % hash->capacidad);
+    if (!lista){
+        free(clave);
+        return NULL;
+    }
+    lista_iter_t iter_clave;
+    iter_buscar_clave(&iter_clave, hash, *lista, clave, h);
+    void* valor = borrar_campo(hash, &iter_clave);
+    iter->generacion = hash->generacion;
+    campo_t buscado = {.clave = clave};
+    arbol_iter_reubicar(iter->orden, hash->indice, &buscado);
+    free(clave);
+    iter_verificar_limite(iter);
+    return valor;
+}
+
+void *hash_iter_borrar_actual(hash_iter_t *iter){
+    if (hash_iter_al_final(iter)) return NULL;
+    if (iter->orden) return iter_ordenado_borrar_actual(iter);
+
+    hash_t* hash = iter->hash;
+    liberar_pendientes(hash);
+    if (atomic_load(&hash->segmentos[iter->pos / TAM_SEGMENTO]->referencias) > 1){
+        // El segmento está compartido: se copia y se busca en la copia el
+        // campo que comparte la clave con el actual
+        campo_t* campo = lista_iter_ver_actual(&iter->iter_lista);
+        lista_t** lista = lista_escritura(hash, iter->pos);
+        if (!lista) return NULL;
+        lista_iter_inicializar(&iter->iter_lista, *lista);
+        while (((campo_t*)lista_iter_ver_actual(&iter->iter_lista))->clave != campo->clave){
+            lista_iter_avanzar(&iter->iter_lista);
+        }
+    }
+    void* valor = borrar_campo(hash, &iter->iter_lista);
+    iter->generacion = hash->generacion;
+    if (lista_iter_al_final(&iter->iter_lista)) iter_ir_a_lista(iter, iter->pos + 1);
+    return valor;
 }
 
 void hash_iter_destruir(hash_iter_t* iter){
-    lista_iter_destruir(iter->iter_lista);
+    if (iter->orden) arbol_iter_destruir(iter->orden);
+    free(iter->limite);
+    free(iter->clave);
     free(iter);
-}
\ No newline at end of file
+}
@@ -7,13 +7,22 @@
 // Los structs deben llamarse "hash" y "hash_iter".
 struct hash;
 struct hash_iter;
+struct hash_instantanea;
+struct hash_internador;
 
 typedef struct hash hash_t;
 typedef struct hash_iter hash_iter_t;
+typedef struct hash_instantanea hash_instantanea_t;
+typedef struct hash_internador hash_internador_t;
 
 // tipo de función para destruir dato
 typedef void (*hash_destruir_dato_t)(void *);
 
+// tipo de función para actualizar dato: recibe el dato actual (NULL si la
+// clave no existía), si la clave existía y el parámetro extra, y devuelve
+// el nuevo dato.
+typedef void *(*hash_actualizar_dato_t)(void *dato, bool existia, void *extra);
+
 /* Crea el hash
  */
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
@@ -25,6 +34,28 @@ hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
  */
 bool hash_guardar(hash_t *hash, const char *clave, void *dato);
 
+/* Busca la clave en el hash haciendo una única pasada y, si no se encuentra,
+ * la inserta con dato NULL. En dato se devuelve la dirección donde se guarda
+ * el valor asociado a la clave, para poder leerlo o modificarlo en el lugar;
+ * no se llama a la función de destrucción sobre el valor anterior. Si
+ * insertado no es NULL, indica si la clave fue insertada. De no poder
+ * insertarla devuelve false.
+ * Pre: La estructura hash fue inicializada
+ * Post: La clave pertenece al hash y *dato apunta a su valor. La dirección
+ * deja de ser válida en la próxima operación que modifique el hash.
+ */
+bool hash_obtener_o_insertar(hash_t *hash, const char *clave, void ***dato, bool *insertado);
+
+/* Reemplaza el valor asociado a la clave por el que devuelve la función
+ * actualizar, que recibe el valor actual (NULL si la clave no estaba) y el
+ * parámetro extra. Busca la clave una única vez, insertándola si no estaba.
+ * No se llama a la función de destrucción sobre el valor anterior. De no
+ * poder insertar la clave devuelve false.
+ * Pre: La estructura hash fue inicializada
+ * Post: El valor asociado a la clave es el que devolvió actualizar.
+ */
+bool hash_actualizar(hash_t *hash, const char *clave, hash_actualizar_dato_t actualizar, void *extra);
+
 /* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
  * NULL si el dato no estaba.
  * Pre: La estructura hash fue inicializada
@@ -44,6 +75,15 @@ void *hash_obtener(const hash_t *hash, const char *clave);
  */
 bool hash_pertenece(const hash_t *hash, const char *clave);
 
+/* Obtiene la copia de la clave que guarda el hash, o NULL si la clave no se
+ * encuentra. Esa clave no se puede modificar ni liberar, y deja de ser
+ * válida cuando se la borra del hash. Si la clave está congelada, se
+ * devuelve decodificada en un buffer del hash que sólo es válido hasta la
+ * próxima llamada a esta función o a hash_congelar_claves.
+ * Pre: La estructura hash fue inicializada
+ */
+const char *hash_obtener_clave(const hash_t *hash, const char *clave);
+
 /* Devuelve la cantidad de elementos del hash.
  * Pre: La estructura hash fue inicializada
  */
@@ -51,25 +91,291 @@ size_t hash_cantidad(const hash_t *hash);
 
 /* Destruye la estructura liberando la memoria pedida y llamando a la función
  * destruir para cada par (clave, dato).
- * Pre: La estructura hash fue inicializada
+ * Pre: La estructura hash fue inicializada y no tiene instantáneas
  * Post: La estructura hash fue destruida
  */
 void hash_destruir(hash_t *hash);
 
-/* Iterador del hash */
+/* Destruye el hash como hash_destruir, pero en un hilo aparte, para que
+ * soltar un hash grande no demore a quien llama: vuelve enseguida, y los
+ * elementos se liberan en segundo plano. La función destruir se llama desde
+ * ese hilo, por lo que debe poder ejecutarse en paralelo con el resto del
+ * programa. Si no se puede crear el hilo, destruye el hash en el momento.
+ * Pre: La estructura hash fue inicializada y no tiene instantáneas
+ * Post: La estructura hash no debe volver a usarse
+ */
+void hash_destruir_diferido(hash_t *hash);
+
+/* Destruye el hash de a partes, para repartir el trabajo en varias
+ * llamadas: cada una libera a lo sumo presupuesto elementos, listas o nodos
+ * del índice ordenado, y devuelve true cuando terminó de destruirlo. La
+ * primera llamada libera además de una vez el filtro, si está activo. Entre
+ * llamadas, el hash sólo puede usarse para seguir destruyéndolo.
+ * Pre: La estructura hash fue inicializada y no tiene instantáneas
+ * Post: Si devolvió true, la estructura hash fue destruida
+ */
+bool hash_destruir_por_partes(hash_t *hash, size_t presupuesto);
+
+/* Vencimientos */
+
+/* Guarda un elemento en el hash como hash_guardar, pero el elemento vence
+ * en el instante ahora + ttl. Los instantes son enteros crecientes en la
+ * unidad que elija el usuario; el instante actual del hash es el mayor
+ * recibido por esta función o por hash_expirar, y sólo ellas lo avanzan.
+ * Una vez vencido respecto de ese instante, el elemento no se encuentra al
+ * buscarlo, y se lo libera (llamando a la función destruir) al borrarlo,
+ * reemplazarlo o en hash_expirar. Las búsquedas no reciben la hora: si sólo
+ * se consulta el hash, hay que llamar a hash_expirar (aunque sea con
+ * presupuesto 0) para que los elementos dejen de encontrarse al vencer.
+ * Guardar la clave con hash_guardar quita su vencimiento. De no poder
+ * guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ * Post: Se almacenó el par (clave, dato) hasta el instante ahora + ttl.
+ */
+bool hash_guardar_con_ttl(hash_t *hash, const char *clave, void *dato, size_t ahora, size_t ttl);
+
+/* Libera elementos vencidos en el instante ahora, revisando a lo sumo
+ * presupuesto elementos con vencimiento, para repartir el trabajo en varias
+ * llamadas. No redimensiona el hash. Devuelve la cantidad de elementos
+ * liberados. Hasta ser liberados, los elementos vencidos se cuentan en
+ * hash_cantidad y los recorre el iterador.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_expirar(hash_t *hash, size_t ahora, size_t presupuesto);
+
+/* Funciones con hash precalculado */
+
+/* Calcula el hash completo de la clave. El valor no depende de ningún hash
+ * en particular, por lo que puede calcularse una vez y usarse con las
+ * funciones *_con_hash de cualquier cantidad de hashes.
+ */
+size_t hash_calcular(const char *clave);
+
+/* Equivalentes a hash_guardar, hash_borrar, hash_obtener y hash_pertenece,
+ * pero reciben el hash de la clave ya calculado.
+ * Pre: La estructura hash fue inicializada, h es hash_calcular(clave)
+ */
+bool hash_guardar_con_hash(hash_t *hash, const char *clave, size_t h, void *dato);
+
+void *hash_borrar_con_hash(hash_t *hash, const char *clave, size_t h);
+
+void *hash_obtener_con_hash(const hash_t *hash, const char *clave, size_t h);
+
+bool hash_pertenece_con_hash(const hash_t *hash, const char *clave, size_t h);
+
+/* Fusión y diferencia */
+
+// Con qué dato queda una clave que está en los dos hashes al fusionarlos.
+typedef enum {
+    HASH_CONSERVAR_DESTINO,
+    HASH_USAR_ORIGEN,
+} hash_politica_t;
+
+/* Mueve todos los elementos de origen a destino, sin copiar las claves ni
+ * volver a calcular sus hashes, y deja origen vacío. Las claves sólo se
+ * copian si los hashes no usan el mismo internador. Si una clave está en
+ * los dos hashes, politica indica con qué dato queda, y el otro se destruye
+ * con la función de destrucción de su hash. Los elementos conservan su
+ * vencimiento; los ya vencidos en origen se destruyen. Devuelve false si
+ * origen tiene instantáneas o si no hubo memoria; en ese caso los elementos
+ * ya movidos quedan en destino y el resto en origen.
+ * Pre: Los hashes fueron inicializados, y la función de destrucción de
+ * destino sirve para los datos de origen
+ */
+bool hash_fusionar(hash_t *destino, hash_t *origen, hash_politica_t politica);
+
+// Cómo cambió una clave de un hash a otro.
+typedef enum {
+    HASH_AGREGADA,
+    HASH_QUITADA,
+    HASH_CAMBIADA,
+} hash_cambio_t;
+
+/* Recorre las diferencias entre los hashes viejo y nuevo, llamando a
+ * visitar con cada clave que está sólo en nuevo (agregada), sólo en viejo
+ * (quitada), o en los dos con datos distintos (cambiada). Los datos se
+ * comparan con iguales, o como punteros si iguales es NULL, y el dato de un
+ * hash que no tiene la clave se pasa como NULL. Los hashes de las claves no
+ * se recalculan. Con hilos mayor a 1 reparte las listas de los hashes entre
+ * esa cantidad de hilos, por lo que visitar e iguales se llaman desde varios
+ * hilos a la vez. El orden de las claves no está definido. El recorrido se
+ * detiene cuando visitar devuelve false. Devuelve false si no hubo memoria.
+ * Pre: Los hashes fueron inicializados y no se modifican mientras tanto
+ */
+bool hash_diferencia(const hash_t *viejo, const hash_t *nuevo, bool iguales(const void *dato_viejo, const void *dato_nuevo), bool visitar(const char *clave, hash_cambio_t cambio, void *dato_viejo, void *dato_nuevo, void *extra), void *extra, size_t hilos);
+
+/* Índice ordenado */
+
+/* Activa un índice con las claves del hash ordenadas, que se mantiene en
+ * cada inserción y borrado, y que permite recorrerlas en orden con
+ * hash_iter_crear_rango y hash_iter_crear_prefijo. Las búsquedas por clave
+ * siguen sin usarlo. Devuelve false si no hubo memoria.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_indice_activar(hash_t *hash);
+
+// Desactiva el índice ordenado y libera su memoria.
+void hash_indice_desactivar(hash_t *hash);
+
+/* Filtro de pertenencia */
+
+/* Activa un filtro de Bloom que se consulta antes de buscar una clave, para
+ * descartar rápido las que no están. Usa bits_por_clave bits por cada clave
+ * que entra en el hash antes de agrandarse: justo antes de agrandarse, con 8
+ * los falsos positivos rondan el 2,5% y con 16 el 0,1%. Conviene cuando la
+ * mayoría de las búsquedas fallan, ya que las que encuentran la clave leen
+ * además el filtro. Con bits_por_clave en 0 lo desactiva. Devuelve
+ * false si no hubo memoria, en cuyo caso el hash queda como estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_filtro_activar(hash_t *hash, size_t bits_por_clave);
+
+// Devuelve la cantidad de búsquedas que consultaron el filtro.
+size_t hash_filtro_consultas(const hash_t *hash);
+
+// Devuelve la cantidad de búsquedas que el filtro descartó sin recorrer el hash.
+size_t hash_filtro_descartes(const hash_t *hash);
+
+// Devuelve la cantidad de búsquedas que el filtro no descartó y no encontraron
+// la clave.
+size_t hash_filtro_falsos_positivos(const hash_t *hash);
+
+/* Reescribe las claves del hash en un único bloque de memoria, ordenadas y
+ * compartiendo los prefijos comunes entre claves consecutivas, lo que ahorra
+ * memoria en hashes que ya no se modifican y cuyas claves comparten prefijos
+ * largos. Las consultas siguen funcionando igual, un poco más lentas. Las
+ * claves que se insertan después se guardan como siempre, y la memoria de
+ * las congeladas que se borran no se recupera hasta volver a congelarlas.
+ * Invalida los iteradores, y las claves obtenidas con hash_obtener_clave.
+ * Devuelve false si no hubo memoria, si el hash tiene instantáneas o si usa
+ * un internador.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_congelar_claves(hash_t *hash);
+
+/* Memoria */
+
+/* Hace que el arreglo de listas y el filtro del hash, cuando ocupan al menos
+ * 2 MiB, se respalden con páginas grandes transparentes (ver memoria.h), lo
+ * que reduce los fallos de TLB al buscar en hashes grandes. Vale desde la
+ * próxima vez que el hash se redimensione o el filtro se reconstruya.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_usar_paginas_grandes(hash_t *hash, bool usar);
+
+/* Limita la memoria del hash, medida como en hash_memoria, a limite bytes, o
+ * quita el límite si es 0. Agregar una clave que no entra devuelve false sin
+ * modificar el hash; reemplazar datos y borrar siempre funciona. Si lo que
+ * no entra es el arreglo de listas agrandado, el hash sigue agregando
+ * claves sin agrandarse. Activar el filtro también respeta el límite.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_limitar_memoria(hash_t *hash, size_t limite);
+
+/* Devuelve una estimación de la memoria que ocupa el hash: el arreglo de
+ * listas, el filtro y las claves congeladas, más por cada clave su campo, su
+ * copia y su nodo de lista. No cuenta el índice, la rueda de vencimientos ni
+ * lo que retienen las instantáneas.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_memoria(const hash_t *hash);
+
+/* Claves internadas */
+
+/* Hace que el hash guarde sus claves en el internador (ver
+ * hash_internador.h) en lugar de copiarlas, así los hashes que comparten
+ * claves las guardan una sola vez, y hash_obtener_clave devuelve la copia
+ * internada. Buscar con una cadena devuelta por hash_internar compara los
+ * punteros en lugar de las cadenas. Las claves de un hash con internador no
+ * se congelan. Devuelve false si el hash no está vacío.
+ * Pre: La estructura hash fue inicializada, y el internador se destruye
+ * después que el hash
+ */
+bool hash_usar_internador(hash_t *hash, hash_internador_t *internador);
+
+/* Instantáneas del hash */
+
+/* Crea una instantánea de solo lectura del hash: ve las claves y datos que
+ * tenía el hash al crearla, sin importar cómo se modifique después. Crearla
+ * no copia los campos; el hash copia por partes lo que modifica mientras
+ * haya instantáneas. Las claves y datos que se borran o reemplazan mientras
+ * tanto no se liberan ni destruyen hasta que no quedan instantáneas, por lo
+ * que el dato devuelto por hash_borrar puede seguir visible en ellas.
+ * Crearla deja inválidos los punteros obtenidos con hash_obtener_o_insertar.
+ * Las consultas a una instantánea pueden hacerse desde otro hilo mientras se
+ * modifica el hash, pero crearla y destruirla no. Devuelve NULL si falla.
+ * Pre: La estructura hash fue inicializada
+ */
+hash_instantanea_t *hash_instantanea_crear(hash_t *hash);
+
+/* Equivalentes a hash_obtener, hash_pertenece y hash_cantidad sobre el
+ * estado del hash al crear la instantánea.
+ * Pre: La instantánea fue creada
+ */
+void *hash_instantanea_obtener(const hash_instantanea_t *inst, const char *clave);
+
+bool hash_instantanea_pertenece(const hash_instantanea_t *inst, const char *clave);
+
+size_t hash_instantanea_cantidad(const hash_instantanea_t *inst);
+
+/* Llama a visitar con cada clave y dato de la instantánea, en un orden
+ * cualquiera, hasta recorrerlos todos o hasta que visitar devuelva false.
+ * Pre: La instantánea fue creada
+ */
+void hash_instantanea_iterar(const hash_instantanea_t *inst, bool visitar(const char *clave, void *dato, void *extra), void *extra);
+
+/* Destruye la instantánea. Las claves y datos que quedaron pendientes se
+ * liberan en la próxima modificación del hash sin otras instantáneas.
+ * Pre: La instantánea fue creada
+ */
+void hash_instantanea_destruir(hash_instantanea_t *inst);
+
+/* Iterador del hash. Si el hash se modifica por fuera del iterador (se
+ * inserta o borra una clave), el iterador queda invalidado: se comporta
+ * como si estuviera al final. Reemplazar el dato de una clave existente no
+ * lo invalida, salvo que existan instantáneas del hash. */
 
 // Crea iterador
 hash_iter_t *hash_iter_crear(const hash_t *hash);
 
+// Crea un iterador que recorre en orden las claves que no son menores que
+// desde y son menores que hasta. Con desde en NULL empieza por la primera
+// clave, y con hasta en NULL sigue hasta la última. Devuelve NULL si no hubo
+// memoria o el hash no tiene el índice ordenado activo.
+hash_iter_t *hash_iter_crear_rango(const hash_t *hash, const char *desde, const char *hasta);
+
+// Crea un iterador que recorre en orden las claves que empiezan con prefijo.
+// Devuelve NULL si no hubo memoria o el hash no tiene el índice ordenado activo.
+hash_iter_t *hash_iter_crear_prefijo(const hash_t *hash, const char *prefijo);
+
 // Avanza iterador
 bool hash_iter_avanzar(hash_iter_t *iter);
 
-// Devuelve clave actual, esa clave no se puede modificar ni liberar.
+// Devuelve clave actual, esa clave no se puede modificar ni liberar. Si está
+// congelada, sólo es válida hasta volver a llamar a esta función.
 const char *hash_iter_ver_actual(const hash_iter_t *iter);
 
+// Devuelve el dato de la clave actual, sin volver a buscarla, o NULL si el
+// iterador está al final.
+void *hash_iter_ver_dato(const hash_iter_t *iter);
+
+// Devuelve el hash completo de la clave actual, el mismo que devuelve
+// hash_calcular, para usarlo con las funciones *_con_hash sin recalcularlo.
+// Pre: el iterador no está al final
+size_t hash_iter_ver_hash(const hash_iter_t *iter);
+
 // Comprueba si terminó la iteración
 bool hash_iter_al_final(const hash_iter_t *iter);
 
+// Comprueba si el hash se modificó por fuera del iterador desde que se lo creó
+bool hash_iter_invalidado(const hash_iter_t *iter);
+
+// Borra del hash la clave actual y devuelve su dato, como hash_borrar, y
+// avanza a la siguiente. No redimensiona el hash ni invalida el iterador.
+// Devuelve NULL si el iterador está al final.
+// Pre: el hash del iterador no fue declarado const
+void *hash_iter_borrar_actual(hash_iter_t *iter);
+
 // Destruye iterador
 void hash_iter_destruir(hash_iter_t* iter);
 
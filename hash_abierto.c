@@ -0,0 +1,239 @@
+#define _POSIX_C_SOURCE 200809L
+#include "hash_abierto.h"
+#include "hash.h"
+#include "memoria.h"
+#include "mezcla.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#define TAM_GRUPO 16
+#define CAPACIDAD_INICIAL_ABIERTO 16
+#define CONTROL_VACIA ((int8_t)-128)
+#define CONTROL_BORRADA ((int8_t)-2)
+
+typedef struct ranura{
+    char* clave;
+    void* dato;
+    size_t hash;
+} ranura_t;
+
+/* control tiene un byte por ranura: CONTROL_VACIA, CONTROL_BORRADA, o los 7
+ * bits bajos del hash mezclado de su clave; los bits restantes eligen el
+ * grupo donde empieza a buscarse. Los grupos se recorren en saltos
+ * crecientes (1, 2, 3...), que con una cantidad de grupos potencia de 2
+ * pasan por todos, y una búsqueda termina en el primer grupo con alguna
+ * ranura vacía.
+ * Por eso al borrar, la ranura sólo vuelve a estar vacía si su grupo ya
+ * tenía alguna vacía: entonces ninguna búsqueda pasó de ese grupo. Si no,
+ * queda borrada hasta redimensionar.
+ * libres es cuántas ranuras vacías pueden ocuparse todavía sin que las
+ * ocupadas y borradas superen 7/8 de la capacidad.
+ * control y ranuras se piden con memoria_reservar. */
+struct hash_abierto{
+    int8_t* control;
+    ranura_t* ranuras;
+    size_t capacidad;
+    size_t cantidad;
+    size_t libres;
+    hash_destruir_dato_t destruir_dato;
+    bool paginas_grandes;
+};
+
+/* Devuelve una máscara con un bit por ranura del grupo cuyo control es
+ * igual a valor */
+uint32_t grupo_iguales(const int8_t* grupo, int8_t valor){
+#ifdef __SSE2__
+    __m128i controles = _mm_load_si128((const __m128i*)grupo);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(controles, _mm_set1_epi8(valor)));
+#else
+    uint32_t mascara = 0;
+    for (int i = 0; i < TAM_GRUPO; i++){
+        if (grupo[i] == valor) mascara |= (uint32_t)1 << i;
+    }
+    return mascara;
+#endif
+}
+
+/* Devuelve una máscara con las ranuras vacías o borradas del grupo, que son
+ * las de control negativo */
+uint32_t grupo_libres(const int8_t* grupo){
+#ifdef __SSE2__
+    return (uint32_t)_mm_movemask_epi8(_mm_load_si128((const __m128i*)grupo));
+#else
+    uint32_t mascara = 0;
+    for (int i = 0; i < TAM_GRUPO; i++){
+        if (grupo[i] < 0) mascara |= (uint32_t)1 << i;
+    }
+    return mascara;
+#endif
+}
+
+size_t carga_maxima(size_t capacidad){
+    return capacidad - capacidad / 8;
+}
+
+/* Devuelve la ranura de la clave de hash h, o la capacidad si no está */
+size_t buscar_ranura(const hash_abierto_t* hash, const char* clave, size_t h){
+    uint64_t x = mezclar((uint64_t)h);
+    int8_t etiqueta = (int8_t)(x & 0x7F);
+    size_t mascara = hash->capacidad / TAM_GRUPO - 1;
+    size_t g = (size_t)(x >> 7) & mascara;
+    for (size_t salto = 1; ; salto++){
+        const int8_t* grupo = hash->control + g * TAM_GRUPO;
+        for (uint32_t m = grupo_iguales(grupo, etiqueta); m; m &= m - 1){
+            size_t i = g * TAM_GRUPO + (size_t)__builtin_ctz(m);
+            if (hash->ranuras[i].hash == h && !strcmp(hash->ranuras[i].clave, clave)) return i;
+        }
+        if (grupo_iguales(grupo, CONTROL_VACIA)) return hash->capacidad;
+        g = (g + salto) & mascara;
+    }
+}
+
+/* Devuelve la primera ranura vacía o borrada donde puede guardarse una
+ * clave de hash h */
+size_t buscar_libre(const hash_abierto_t* hash, size_t h){
+    uint64_t x = mezclar((uint64_t)h);
+    size_t mascara = hash->capacidad / TAM_GRUPO - 1;
+    size_t g = (size_t)(x >> 7) & mascara;
+    for (size_t salto = 1; ; salto++){
+        uint32_t m = grupo_libres(hash->control + g * TAM_GRUPO);
+        if (m) return g * TAM_GRUPO + (size_t)__builtin_ctz(m);
+        g = (g + salto) & mascara;
+    }
+}
+
+/* Ocupa la ranura i con la clave de hash h */
+void ocupar_ranura(hash_abierto_t* hash, size_t i, char* clave, size_t h, void* dato){
+    if (hash->control[i] == CONTROL_VACIA) hash->libres--;
+    hash->control[i] = (int8_t)(mezclar((uint64_t)h) & 0x7F);
+    hash->ranuras[i].clave = clave;
+    hash->ranuras[i].dato = dato;
+    hash->ranuras[i].hash = h;
+}
+
+bool crear_ranuras(hash_abierto_t* hash, size_t capacidad){
+    int8_t* control = memoria_reservar(capacidad, hash->paginas_grandes);
+    if (!control) return false;
+    ranura_t* ranuras = memoria_reservar(capacidad * sizeof(ranura_t), hash->paginas_grandes);
+    if (!ranuras){
+        memoria_liberar(control, capacidad);
+        return false;
+    }
+    memset(control, CONTROL_VACIA, capacidad);
+    hash->control = control;
+    hash->ranuras = ranuras;
+    hash->capacidad = capacidad;
+    hash->libres = carga_maxima(capacidad);
+    return true;
+}
+
+/* Vuelve a ubicar las claves en ranuras nuevas, sin borradas: del doble de
+ * capacidad si las ocupadas pasan de la mitad de la carga máxima, o de la
+ * misma si no. Usa el hash guardado de cada clave, sin recalcularlo. */
+bool redimensionar_abierto(hash_abierto_t* hash){
+    int8_t* control = hash->control;
+    ranura_t* ranuras = hash->ranuras;
+    size_t capacidad = hash->capacidad;
+    size_t nueva = hash->cantidad >= carga_maxima(capacidad) / 2 ? capacidad * 2 : capacidad;
+    if (!crear_ranuras(hash, nueva)) return false;
+    for (size_t i = 0; i < capacidad; i++){
+        if (control[i] < 0) continue;
+        ranura_t* ranura = &ranuras[i];
+        ocupar_ranura(hash, buscar_libre(hash, ranura->hash), ranura->clave, ranura->hash, ranura->dato);
+    }
+    memoria_liberar(control, capacidad);
+    memoria_liberar(ranuras, capacidad * sizeof(ranura_t));
+    return true;
+}
+
+hash_abierto_t *hash_abierto_crear(hash_destruir_dato_t destruir_dato){
+    hash_abierto_t* hash = malloc(sizeof(hash_abierto_t));
+    if (!hash) return NULL;
+    hash->paginas_grandes = false;
+    if (!crear_ranuras(hash, CAPACIDAD_INICIAL_ABIERTO)){
+        free(hash);
+        return NULL;
+    }
+    hash->cantidad = 0;
+    hash->destruir_dato = destruir_dato;
+    return hash;
+}
+
+bool hash_abierto_guardar(hash_abierto_t *hash, const char *clave, void *dato){
+    size_t h = hash_calcular(clave);
+    size_t i = buscar_ranura(hash, clave, h);
+    if (i < hash->capacidad){
+        if (hash->destruir_dato) hash->destruir_dato(hash->ranuras[i].dato);
+        hash->ranuras[i].dato = dato;
+        return true;
+    }
+    char* copia = strdup(clave);
+    if (!copia) return false;
+    i = buscar_libre(hash, h);
+    // Reusar una ranura borrada no consume libres
+    if (!hash->libres && hash->control[i] == CONTROL_VACIA){
+        if (!redimensionar_abierto(hash)){
+            free(copia);
+            return false;
+        }
+        i = buscar_libre(hash, h);
+    }
+    ocupar_ranura(hash, i, copia, h, dato);
+    hash->cantidad++;
+    return true;
+}
+
+void *hash_abierto_borrar(hash_abierto_t *hash, const char *clave){
+    size_t i = buscar_ranura(hash, clave, hash_calcular(clave));
+    if (i == hash->capacidad) return NULL;
+    void* dato = hash->ranuras[i].dato;
+    free(hash->ranuras[i].clave);
+    if (grupo_iguales(hash->control + i / TAM_GRUPO * TAM_GRUPO, CONTROL_VACIA)){
+        hash->control[i] = CONTROL_VACIA;
+        hash->libres++;
+    }
+    else{
+        hash->control[i] = CONTROL_BORRADA;
+    }
+    hash->cantidad--;
+    return dato;
+}
+
+void *hash_abierto_obtener(const hash_abierto_t *hash, const char *clave){
+    size_t i = buscar_ranura(hash, clave, hash_calcular(clave));
+    return i < hash->capacidad ? hash->ranuras[i].dato : NULL;
+}
+
+bool hash_abierto_pertenece(const hash_abierto_t *hash, const char *clave){
+    return buscar_ranura(hash, clave, hash_calcular(clave)) < hash->capacidad;
+}
+
+size_t hash_abierto_cantidad(const hash_abierto_t *hash){
+    return hash->cantidad;
+}
+
+void hash_abierto_usar_paginas_grandes(hash_abierto_t *hash, bool usar){
+    hash->paginas_grandes = usar;
+}
+
+void hash_abierto_iterar(const hash_abierto_t *hash, bool visitar(const char *clave, void *dato, void *extra), void *extra){
+    for (size_t i = 0; i < hash->capacidad; i++){
+        if (hash->control[i] < 0) continue;
+        if (!visitar(hash->ranuras[i].clave, hash->ranuras[i].dato, extra)) return;
+    }
+}
+
+void hash_abierto_destruir(hash_abierto_t *hash){
+    for (size_t i = 0; i < hash->capacidad; i++){
+        if (hash->control[i] < 0) continue;
+        if (hash->destruir_dato) hash->destruir_dato(hash->ranuras[i].dato);
+        free(hash->ranuras[i].clave);
+    }
+    memoria_liberar(hash->control, hash->capacidad);
+    memoria_liberar(hash->ranuras, hash->capacidad * sizeof(ranura_t));
+    free(hash);
+}
@@ -0,0 +1,65 @@
+#ifndef HASH_ABIERTO_H
+#define HASH_ABIERTO_H
+
+#include "hash.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Hash de direccionamiento abierto al estilo SwissTable: las claves se
+ * guardan en un arreglo de ranuras, con un byte de control por ranura que
+ * tiene 7 bits del hash de la clave o indica si está vacía o borrada. Una
+ * búsqueda compara los bytes de control de grupos de 16 ranuras a la vez,
+ * por lo que casi siempre lee un solo grupo y compara a lo sumo una clave.
+ * Conviene sobre hash_t cuando importa la velocidad de las búsquedas y no
+ * hacen falta vencimientos, instantáneas ni iteradores. */
+struct hash_abierto;
+
+typedef struct hash_abierto hash_abierto_t;
+
+/* Crea el hash, o devuelve NULL si no hubo memoria.
+ */
+hash_abierto_t *hash_abierto_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda un elemento en el hash; si la clave ya se encuentra, reemplaza su
+ * dato destruyendo el anterior. De no poder guardarlo devuelve false.
+ * Pre: El hash fue creado
+ */
+bool hash_abierto_guardar(hash_abierto_t *hash, const char *clave, void *dato);
+
+/* Borra la clave y devuelve su dato, o NULL si no estaba.
+ * Pre: El hash fue creado
+ */
+void *hash_abierto_borrar(hash_abierto_t *hash, const char *clave);
+
+/* Devuelve el dato de la clave, o NULL si no está.
+ * Pre: El hash fue creado
+ */
+void *hash_abierto_obtener(const hash_abierto_t *hash, const char *clave);
+
+/* Determina si la clave está en el hash.
+ * Pre: El hash fue creado
+ */
+bool hash_abierto_pertenece(const hash_abierto_t *hash, const char *clave);
+
+// Devuelve la cantidad de elementos del hash.
+size_t hash_abierto_cantidad(const hash_abierto_t *hash);
+
+/* Hace que las ranuras, cuando ocupan al menos 2 MiB, se respalden con
+ * páginas grandes transparentes (ver memoria.h). Vale desde la próxima vez
+ * que el hash se redimensione.
+ * Pre: El hash fue creado
+ */
+void hash_abierto_usar_paginas_grandes(hash_abierto_t *hash, bool usar);
+
+/* Llama a visitar con cada clave y su dato, hasta recorrerlas todas o hasta
+ * que visitar devuelva false. No debe modificarse el hash mientras.
+ * Pre: El hash fue creado
+ */
+void hash_abierto_iterar(const hash_abierto_t *hash, bool visitar(const char *clave, void *dato, void *extra), void *extra);
+
+/* Destruye el hash llamando a destruir_dato para cada dato.
+ * Pre: El hash fue creado
+ */
+void hash_abierto_destruir(hash_abierto_t *hash);
+
+#endif // HASH_ABIERTO_H
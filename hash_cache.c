@@ -0,0 +1,165 @@
+#include "hash_cache.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Las entradas son los datos del hash y forman además una lista doblemente
+ * enlazada por antigüedad, de la más reciente (prim) a la menos (ult). La
+ * clave de cada entrada es la copia que guarda el hash. */
+typedef struct entrada{
+    const char* clave;
+    void* dato;
+    size_t tam;
+    struct entrada* ant;
+    struct entrada* prox;
+} entrada_t;
+
+struct hash_cache{
+    hash_t* hash;
+    entrada_t* prim;
+    entrada_t* ult;
+    size_t max_entradas;
+    size_t max_bytes;
+    size_t bytes;
+    size_t aciertos;
+    size_t fallos;
+    hash_destruir_dato_t destruir_dato;
+};
+
+hash_cache_t *hash_cache_crear(size_t max_entradas, size_t max_bytes, hash_destruir_dato_t destruir_dato){
+    hash_cache_t* cache = malloc(sizeof(hash_cache_t));
+    if (!cache) return NULL;
+
+    cache->hash = hash_crear(NULL);
+    if (!cache->hash){
+        free(cache);
+        return NULL;
+    }
+
+    cache->prim = NULL;
+    cache->ult = NULL;
+    cache->max_entradas = max_entradas;
+    cache->max_bytes = max_bytes;
+    cache->bytes = 0;
+    cache->aciertos = 0;
+    cache->fallos = 0;
+    cache->destruir_dato = destruir_dato;
+    return cache;
+}
+
+void desenlazar_entrada(hash_cache_t* cache, entrada_t* entrada){
+    if (entrada->ant) entrada->ant->prox = entrada->prox;
+    else cache->prim = entrada->prox;
+    if (entrada->prox) entrada->prox->ant = entrada->ant;
+    else cache->ult = entrada->ant;
+}
+
+void enlazar_primera(hash_cache_t* cache, entrada_t* entrada){
+    entrada->ant = NULL;
+    entrada->prox = cache->prim;
+    if (cache->prim) cache->prim->ant = entrada;
+    else cache->ult = entrada;
+    cache->prim = entrada;
+}
+
+/* Quita la entrada de la lista y del hash, y devuelve su dato */
+void* quitar_entrada(hash_cache_t* cache, entrada_t* entrada){
+    void* dato = entrada->dato;
+    desenlazar_entrada(cache, entrada);
+    cache->bytes -= entrada->tam;
+    hash_borrar(cache->hash, entrada->clave);
+    free(entrada);
+    return dato;
+}
+
+bool excede_maximos(const hash_cache_t* cache){
+    if (cache->max_entradas && hash_cantidad(cache->hash) > cache->max_entradas) return true;
+    return cache->max_bytes && cache->bytes > cache->max_bytes;
+}
+
+bool hash_cache_guardar(hash_cache_t *cache, const char *clave, void *dato, size_t tam){
+    if (cache->max_bytes && tam > cache->max_bytes) return false;
+
+    void** valor;
+    bool insertado;
+    if (!hash_obtener_o_insertar(cache->hash, clave, &valor, &insertado)) return false;
+
+    entrada_t* entrada = *valor;
+    if (insertado){
+        entrada = malloc(sizeof(entrada_t));
+        if (!entrada){
+            hash_borrar(cache->hash, clave);
+            return false;
+        }
+        entrada->clave = hash_obtener_clave(cache->hash, clave);
+        entrada->tam = 0;
+        *valor = entrada;
+    }
+    else{
+        desenlazar_entrada(cache, entrada);
+        if (cache->destruir_dato) cache->destruir_dato(entrada->dato);
+    }
+    entrada->dato = dato;
+    cache->bytes = cache->bytes - entrada->tam + tam;
+    entrada->tam = tam;
+    enlazar_primera(cache, entrada);
+
+    // La entrada recién guardada es la primera, y entra sola en los máximos
+    while (excede_maximos(cache)){
+        void* descartado = quitar_entrada(cache, cache->ult);
+        if (cache->destruir_dato) cache->destruir_dato(descartado);
+    }
+    return true;
+}
+
+void *hash_cache_obtener(hash_cache_t *cache, const char *clave){
+    entrada_t* entrada = hash_obtener(cache->hash, clave);
+    if (!entrada){
+        cache->fallos++;
+        return NULL;
+    }
+    cache->aciertos++;
+    if (entrada != cache->prim){
+        desenlazar_entrada(cache, entrada);
+        enlazar_primera(cache, entrada);
+    }
+    return entrada->dato;
+}
+
+bool hash_cache_pertenece(const hash_cache_t *cache, const char *clave){
+    return hash_pertenece(cache->hash, clave);
+}
+
+void *hash_cache_borrar(hash_cache_t *cache, const char *clave){
+    entrada_t* entrada = hash_obtener(cache->hash, clave);
+    if (!entrada) return NULL;
+    return quitar_entrada(cache, entrada);
+}
+
+size_t hash_cache_cantidad(const hash_cache_t *cache){
+    return hash_cantidad(cache->hash);
+}
+
+size_t hash_cache_bytes(const hash_cache_t *cache){
+    return cache->bytes;
+}
+
+size_t hash_cache_aciertos(const hash_cache_t *cache){
+    return cache->aciertos;
+}
+
+size_t hash_cache_fallos(const hash_cache_t *cache){
+    return cache->fallos;
+}
+
+void hash_cache_destruir(hash_cache_t *cache){
+    entrada_t* entrada = cache->prim;
+    while (entrada){
+        entrada_t* prox = entrada->prox;
+        if (cache->destruir_dato) cache->destruir_dato(entrada->dato);
+        free(entrada);
+        entrada = prox;
+    }
+    hash_destruir(cache->hash);
+    free(cache);
+}
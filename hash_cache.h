@@ -0,0 +1,64 @@
+#ifndef HASH_CACHE_H
+#define HASH_CACHE_H
+
+#include "hash.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Caché acotada sobre un hash. Cada entrada tiene un tamaño en bytes
+ * informado por el usuario; al superarse la cantidad máxima de entradas o de
+ * bytes, se descartan las entradas usadas hace más tiempo (LRU). */
+struct hash_cache;
+
+typedef struct hash_cache hash_cache_t;
+
+/* Crea la caché. Un máximo en 0 indica que no hay límite para esa medida.
+ * La función destruir_dato se llama sobre cada dato que se reemplaza, se
+ * descarta o queda en la caché al destruirla.
+ */
+hash_cache_t *hash_cache_crear(size_t max_entradas, size_t max_bytes, hash_destruir_dato_t destruir_dato);
+
+/* Guarda el dato de tamaño tam en la caché, reemplazando el anterior si la
+ * clave ya estaba, y lo marca como el más reciente. Descarta las entradas
+ * menos recientes que hagan falta para respetar los máximos. Devuelve false
+ * si no se pudo guardar, o si tam supera por sí solo el máximo de bytes; en
+ * ese caso el dato sigue siendo del llamador.
+ * Pre: La caché fue creada
+ */
+bool hash_cache_guardar(hash_cache_t *cache, const char *clave, void *dato, size_t tam);
+
+/* Obtiene el dato de la clave y la marca como la más reciente. Devuelve NULL
+ * si la clave no está. Cuenta un acierto o un fallo.
+ * Pre: La caché fue creada
+ */
+void *hash_cache_obtener(hash_cache_t *cache, const char *clave);
+
+/* Determina si la clave está en la caché, sin modificar su antigüedad ni
+ * los contadores.
+ * Pre: La caché fue creada
+ */
+bool hash_cache_pertenece(const hash_cache_t *cache, const char *clave);
+
+/* Quita la clave de la caché y devuelve su dato, o NULL si no estaba.
+ * Pre: La caché fue creada
+ */
+void *hash_cache_borrar(hash_cache_t *cache, const char *clave);
+
+// Devuelve la cantidad de entradas de la caché.
+size_t hash_cache_cantidad(const hash_cache_t *cache);
+
+// Devuelve la suma de los tamaños de las entradas de la caché.
+size_t hash_cache_bytes(const hash_cache_t *cache);
+
+// Devuelve la cantidad de llamadas a hash_cache_obtener que encontraron la clave.
+size_t hash_cache_aciertos(const hash_cache_t *cache);
+
+// Devuelve la cantidad de llamadas a hash_cache_obtener que no la encontraron.
+size_t hash_cache_fallos(const hash_cache_t *cache);
+
+/* Destruye la caché llamando a destruir_dato para cada dato.
+ * Pre: La caché fue creada
+ */
+void hash_cache_destruir(hash_cache_t *cache);
+
+#endif // HASH_CACHE_H
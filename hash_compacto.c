@@ -0,0 +1,220 @@
+#include "hash_compacto.h"
+#include "hash.h"
+#include "mezcla.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#define CAPACIDAD_INICIAL_COMPACTO 16
+#define CAPACIDAD_MAXIMA_COMPACTO ((size_t)1 << 31)
+#define ENTRADAS_MAXIMAS ((size_t)UINT32_MAX - 1)
+#define TAM_MAXIMO_CLAVES ((size_t)UINT32_MAX)
+#define CLAVE_BORRADA UINT32_MAX
+
+/* Los enlaces entre entradas son índices en entradas más uno, y 0 es el
+ * final de la cadena, así un arreglo de cabezas en cero no tiene entradas.
+ * clave es la posición de la clave en claves, y largo su largo sin el 0
+ * final. hash son 32 bits del hash mezclado de la clave, cuyos bits bajos
+ * eligen la cadena, por lo que al redimensionar no se vuelve a calcular. */
+typedef struct entrada{
+    void* dato;
+    uint32_t clave;
+    uint32_t largo;
+    uint32_t hash;
+    uint32_t siguiente;
+} entrada_t;
+
+/* Las entradas borradas tienen clave CLAVE_BORRADA y se enlazan en libres
+ * para reusarlas. Las claves borradas dejan su lugar sin usar en claves, que
+ * se compacta cuando hace falta lugar y lo sin usar es más que lo usado. */
+struct hash_compacto{
+    entrada_t* entradas;
+    size_t cant_entradas;
+    size_t cap_entradas;
+    uint32_t libres;
+    uint32_t* cabezas;
+    size_t capacidad;
+    char* claves;
+    size_t tam_claves;
+    size_t cap_claves;
+    size_t claves_sin_usar;
+    size_t cantidad;
+    hash_destruir_dato_t destruir_dato;
+};
+
+uint32_t hash_compacto_calcular(const char* clave){
+    return (uint32_t)mezclar((uint64_t)hash_calcular(clave));
+}
+
+/* Devuelve el enlace que apunta a la entrada de la clave dentro de su
+ * cadena, que vale 0 si la clave no está */
+uint32_t* enlace_de_clave(const hash_compacto_t* hash, const char* clave, size_t largo, uint32_t h){
+    uint32_t* enlace = &hash->cabezas[h & (hash->capacidad - 1)];
+    while (*enlace){
+        const entrada_t* entrada = &hash->entradas[*enlace - 1];
+        if (entrada->hash == h && entrada->largo == largo && !memcmp(hash->claves + entrada->clave, clave, largo)) break;
+        enlace = &hash->entradas[*enlace - 1].siguiente;
+    }
+    return enlace;
+}
+
+/* Se asegura de que haya una entrada libre */
+bool reservar_entrada(hash_compacto_t* hash){
+    if (hash->libres || hash->cant_entradas < hash->cap_entradas) return true;
+    if (hash->cant_entradas == ENTRADAS_MAXIMAS) return false;
+    size_t capacidad = hash->cap_entradas * 2;
+    if (capacidad > ENTRADAS_MAXIMAS) capacidad = ENTRADAS_MAXIMAS;
+    entrada_t* entradas = realloc(hash->entradas, capacidad * sizeof(entrada_t));
+    if (!entradas) return false;
+    hash->entradas = entradas;
+    hash->cap_entradas = capacidad;
+    return true;
+}
+
+/* Se asegura de que entre una clave de largo dado en claves, primero
+ * compactándolas si lo sin usar es más que lo usado, y si no agrandándolas */
+bool reservar_clave(hash_compacto_t* hash, size_t largo){
+    if (hash->tam_claves + largo + 1 <= hash->cap_claves) return true;
+    size_t usado = hash->tam_claves - hash->claves_sin_usar;
+    if (usado + largo + 1 > TAM_MAXIMO_CLAVES) return false;
+    size_t capacidad = hash->claves_sin_usar > usado ? hash->cap_claves : hash->cap_claves * 2;
+    while (capacidad < usado + largo + 1) capacidad *= 2;
+    if (capacidad > TAM_MAXIMO_CLAVES) capacidad = TAM_MAXIMO_CLAVES;
+    char* claves = malloc(capacidad);
+    if (!claves) return false;
+    size_t tam = 0;
+    for (size_t i = 0; i < hash->cant_entradas; i++){
+        entrada_t* entrada = &hash->entradas[i];
+        if (entrada->clave == CLAVE_BORRADA) continue;
+        memcpy(claves + tam, hash->claves + entrada->clave, entrada->largo + 1);
+        entrada->clave = (uint32_t)tam;
+        tam += entrada->largo + 1;
+    }
+    free(hash->claves);
+    hash->claves = claves;
+    hash->tam_claves = tam;
+    hash->cap_claves = capacidad;
+    hash->claves_sin_usar = 0;
+    return true;
+}
+
+/* Duplica la cantidad de cadenas y vuelve a enlazar las entradas */
+bool redimensionar_compacto(hash_compacto_t* hash){
+    size_t capacidad = hash->capacidad * 2;
+    uint32_t* cabezas = calloc(capacidad, sizeof(uint32_t));
+    if (!cabezas) return false;
+    for (size_t i = 0; i < hash->cant_entradas; i++){
+        entrada_t* entrada = &hash->entradas[i];
+        if (entrada->clave == CLAVE_BORRADA) continue;
+        uint32_t* cabeza = &cabezas[entrada->hash & (capacidad - 1)];
+        entrada->siguiente = *cabeza;
+        *cabeza = (uint32_t)(i + 1);
+    }
+    free(hash->cabezas);
+    hash->cabezas = cabezas;
+    hash->capacidad = capacidad;
+    return true;
+}
+
+hash_compacto_t *hash_compacto_crear(hash_destruir_dato_t destruir_dato){
+    hash_compacto_t* hash = malloc(sizeof(hash_compacto_t));
+    if (!hash) return NULL;
+    hash->entradas = malloc(CAPACIDAD_INICIAL_COMPACTO * sizeof(entrada_t));
+    hash->cabezas = calloc(CAPACIDAD_INICIAL_COMPACTO, sizeof(uint32_t));
+    hash->claves = malloc(CAPACIDAD_INICIAL_COMPACTO * 8);
+    if (!hash->entradas || !hash->cabezas || !hash->claves){
+        free(hash->entradas); free(hash->cabezas); free(hash->claves); free(hash);
+        return NULL;
+    }
+    hash->cant_entradas = 0;
+    hash->cap_entradas = CAPACIDAD_INICIAL_COMPACTO;
+    hash->libres = 0;
+    hash->capacidad = CAPACIDAD_INICIAL_COMPACTO;
+    hash->tam_claves = 0;
+    hash->cap_claves = CAPACIDAD_INICIAL_COMPACTO * 8;
+    hash->claves_sin_usar = 0;
+    hash->cantidad = 0;
+    hash->destruir_dato = destruir_dato;
+    return hash;
+}
+
+bool hash_compacto_guardar(hash_compacto_t *hash, const char *clave, void *dato){
+    size_t largo = strlen(clave);
+    uint32_t h = hash_compacto_calcular(clave);
+    uint32_t* enlace = enlace_de_clave(hash, clave, largo, h);
+    if (*enlace){
+        entrada_t* entrada = &hash->entradas[*enlace - 1];
+        if (hash->destruir_dato) hash->destruir_dato(entrada->dato);
+        entrada->dato = dato;
+        return true;
+    }
+    if (!reservar_entrada(hash) || !reservar_clave(hash, largo)) return false;
+    if (hash->cantidad >= hash->capacidad && hash->capacidad < CAPACIDAD_MAXIMA_COMPACTO){
+        if (!redimensionar_compacto(hash)) return false;
+    }
+
+    uint32_t i = hash->libres;
+    if (i) hash->libres = hash->entradas[i - 1].siguiente;
+    else i = (uint32_t)++hash->cant_entradas;
+    entrada_t* entrada = &hash->entradas[i - 1];
+    memcpy(hash->claves + hash->tam_claves, clave, largo + 1);
+    entrada->dato = dato;
+    entrada->clave = (uint32_t)hash->tam_claves;
+    entrada->largo = (uint32_t)largo;
+    entrada->hash = h;
+    hash->tam_claves += largo + 1;
+    uint32_t* cabeza = &hash->cabezas[h & (hash->capacidad - 1)];
+    entrada->siguiente = *cabeza;
+    *cabeza = i;
+    hash->cantidad++;
+    return true;
+}
+
+void *hash_compacto_borrar(hash_compacto_t *hash, const char *clave){
+    uint32_t* enlace = enlace_de_clave(hash, clave, strlen(clave), hash_compacto_calcular(clave));
+    uint32_t i = *enlace;
+    if (!i) return NULL;
+    entrada_t* entrada = &hash->entradas[i - 1];
+    *enlace = entrada->siguiente;
+    hash->claves_sin_usar += entrada->largo + 1;
+    entrada->clave = CLAVE_BORRADA;
+    entrada->siguiente = hash->libres;
+    hash->libres = i;
+    hash->cantidad--;
+    return entrada->dato;
+}
+
+void *hash_compacto_obtener(const hash_compacto_t *hash, const char *clave){
+    uint32_t i = *enlace_de_clave(hash, clave, strlen(clave), hash_compacto_calcular(clave));
+    return i ? hash->entradas[i - 1].dato : NULL;
+}
+
+bool hash_compacto_pertenece(const hash_compacto_t *hash, const char *clave){
+    return *enlace_de_clave(hash, clave, strlen(clave), hash_compacto_calcular(clave)) != 0;
+}
+
+size_t hash_compacto_cantidad(const hash_compacto_t *hash){
+    return hash->cantidad;
+}
+
+size_t hash_compacto_memoria(const hash_compacto_t *hash){
+    return sizeof(hash_compacto_t) + hash->cap_entradas * sizeof(entrada_t) + hash->capacidad * sizeof(uint32_t) + hash->cap_claves;
+}
+
+void hash_compacto_iterar(const hash_compacto_t *hash, bool visitar(const char *clave, void *dato, void *extra), void *extra){
+    for (size_t i = 0; i < hash->cant_entradas; i++){
+        const entrada_t* entrada = &hash->entradas[i];
+        if (entrada->clave == CLAVE_BORRADA) continue;
+        if (!visitar(hash->claves + entrada->clave, entrada->dato, extra)) return;
+    }
+}
+
+void hash_compacto_destruir(hash_compacto_t *hash){
+    for (size_t i = 0; hash->destruir_dato && i < hash->cant_entradas; i++){
+        if (hash->entradas[i].clave != CLAVE_BORRADA) hash->destruir_dato(hash->entradas[i].dato);
+    }
+    free(hash->entradas);
+    free(hash->cabezas);
+    free(hash->claves);
+    free(hash);
+}
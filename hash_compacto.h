@@ -0,0 +1,63 @@
+#ifndef HASH_COMPACTO_H
+#define HASH_COMPACTO_H
+
+#include "hash.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Hash encadenado compacto, para tablas de claves chicas: las entradas se
+ * guardan en un único arreglo y se enlazan por índices de 32 bits en lugar
+ * de punteros, y las claves se copian todas seguidas en un único bloque, sin
+ * un pedido de memoria por clave. Con claves de 8 caracteres ocupa unos 40
+ * bytes por clave, contra unos 160 de hash_t. Admite hasta 2^32 - 2 claves
+ * y 4 GiB de claves. Borrar no devuelve memoria: la entrada queda libre para
+ * la próxima clave que se guarde, y los bytes de la clave se recuperan
+ * cuando el bloque se llena y más de la mitad está sin usar, compactándolo
+ * en lugar de agrandarlo. */
+struct hash_compacto;
+
+typedef struct hash_compacto hash_compacto_t;
+
+/* Crea el hash, o devuelve NULL si no hubo memoria.
+ */
+hash_compacto_t *hash_compacto_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda un elemento en el hash; si la clave ya se encuentra, reemplaza su
+ * dato destruyendo el anterior. De no poder guardarlo devuelve false.
+ * Pre: El hash fue creado
+ */
+bool hash_compacto_guardar(hash_compacto_t *hash, const char *clave, void *dato);
+
+/* Borra la clave y devuelve su dato, o NULL si no estaba.
+ * Pre: El hash fue creado
+ */
+void *hash_compacto_borrar(hash_compacto_t *hash, const char *clave);
+
+/* Devuelve el dato de la clave, o NULL si no está.
+ * Pre: El hash fue creado
+ */
+void *hash_compacto_obtener(const hash_compacto_t *hash, const char *clave);
+
+/* Determina si la clave está en el hash.
+ * Pre: El hash fue creado
+ */
+bool hash_compacto_pertenece(const hash_compacto_t *hash, const char *clave);
+
+// Devuelve la cantidad de elementos del hash.
+size_t hash_compacto_cantidad(const hash_compacto_t *hash);
+
+// Devuelve los bytes que tiene pedidos el hash.
+size_t hash_compacto_memoria(const hash_compacto_t *hash);
+
+/* Llama a visitar con cada clave y su dato, hasta recorrerlas todas o hasta
+ * que visitar devuelva false. No debe modificarse el hash mientras.
+ * Pre: El hash fue creado
+ */
+void hash_compacto_iterar(const hash_compacto_t *hash, bool visitar(const char *clave, void *dato, void *extra), void *extra);
+
+/* Destruye el hash llamando a destruir_dato para cada dato.
+ * Pre: El hash fue creado
+ */
+void hash_compacto_destruir(hash_compacto_t *hash);
+
+#endif // HASH_COMPACTO_H
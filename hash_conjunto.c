@@ -0,0 +1,100 @@
+#include "hash_conjunto.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Las claves se guardan en un hash con dato NULL. No vale la pena quitar el
+ * puntero al dato de cada campo: sin él el campo pasa de 40 a 32 bytes, y
+ * malloc le reserva el mismo bloque de 48 en ambos casos. */
+struct hash_conjunto{
+    hash_t* hash;
+};
+
+hash_conjunto_t *hash_conjunto_crear(void){
+    hash_conjunto_t* conj = malloc(sizeof(hash_conjunto_t));
+    if (!conj) return NULL;
+    conj->hash = hash_crear(NULL);
+    if (!conj->hash){
+        free(conj);
+        return NULL;
+    }
+    return conj;
+}
+
+bool hash_conjunto_agregar(hash_conjunto_t *conj, const char *clave){
+    void** dato;
+    return hash_obtener_o_insertar(conj->hash, clave, &dato, NULL);
+}
+
+bool hash_conjunto_pertenece(const hash_conjunto_t *conj, const char *clave){
+    return hash_pertenece(conj->hash, clave);
+}
+
+bool hash_conjunto_borrar(hash_conjunto_t *conj, const char *clave){
+    size_t h = hash_calcular(clave);
+    if (!hash_pertenece_con_hash(conj->hash, clave, h)) return false;
+    hash_borrar_con_hash(conj->hash, clave, h);
+    return true;
+}
+
+size_t hash_conjunto_cantidad(const hash_conjunto_t *conj){
+    return hash_cantidad(conj->hash);
+}
+
+void hash_conjunto_iterar(const hash_conjunto_t *conj, bool visitar(const char *clave, void *extra), void *extra){
+    hash_iter_t* iter = hash_iter_crear(conj->hash);
+    if (!iter) return;
+    while (!hash_iter_al_final(iter) && visitar(hash_iter_ver_actual(iter), extra)){
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+}
+
+/* Agrega a destino las claves de origen; si filtro no es NULL, sólo las que
+ * también están en filtro. */
+bool copiar_claves(hash_t* destino, const hash_t* origen, const hash_t* filtro){
+    hash_iter_t* iter = hash_iter_crear(origen);
+    if (!iter) return false;
+    bool ok = true;
+    while (ok && !hash_iter_al_final(iter)){
+        const char* clave = hash_iter_ver_actual(iter);
+        size_t h = hash_iter_ver_hash(iter);
+        if (!filtro || hash_pertenece_con_hash(filtro, clave, h)){
+            ok = hash_guardar_con_hash(destino, clave, h, NULL);
+        }
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    return ok;
+}
+
+hash_conjunto_t *hash_conjunto_union(const hash_conjunto_t *a, const hash_conjunto_t *b){
+    hash_conjunto_t* conj = hash_conjunto_crear();
+    if (!conj) return NULL;
+    if (!copiar_claves(conj->hash, a->hash, NULL) || !copiar_claves(conj->hash, b->hash, NULL)){
+        hash_conjunto_destruir(conj);
+        return NULL;
+    }
+    return conj;
+}
+
+hash_conjunto_t *hash_conjunto_interseccion(const hash_conjunto_t *a, const hash_conjunto_t *b){
+    // Se recorre el menor y se busca cada clave en el mayor
+    if (hash_cantidad(a->hash) > hash_cantidad(b->hash)){
+        const hash_conjunto_t* aux = a;
+        a = b;
+        b = aux;
+    }
+    hash_conjunto_t* conj = hash_conjunto_crear();
+    if (!conj) return NULL;
+    if (!copiar_claves(conj->hash, a->hash, b->hash)){
+        hash_conjunto_destruir(conj);
+        return NULL;
+    }
+    return conj;
+}
+
+void hash_conjunto_destruir(hash_conjunto_t *conj){
+    hash_destruir(conj->hash);
+    free(conj);
+}
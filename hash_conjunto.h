@@ -0,0 +1,54 @@
+#ifndef HASH_CONJUNTO_H
+#define HASH_CONJUNTO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Conjunto de claves, guardado en un hash sin datos. */
+struct hash_conjunto;
+
+typedef struct hash_conjunto hash_conjunto_t;
+
+/* Crea el conjunto vacío, o devuelve NULL si no hubo memoria.
+ */
+hash_conjunto_t *hash_conjunto_crear(void);
+
+/* Agrega la clave al conjunto, si no estaba. Devuelve false si no se pudo
+ * agregar.
+ * Pre: El conjunto fue creado
+ */
+bool hash_conjunto_agregar(hash_conjunto_t *conj, const char *clave);
+
+/* Determina si la clave está en el conjunto.
+ * Pre: El conjunto fue creado
+ */
+bool hash_conjunto_pertenece(const hash_conjunto_t *conj, const char *clave);
+
+/* Quita la clave del conjunto. Devuelve false si no estaba.
+ * Pre: El conjunto fue creado
+ */
+bool hash_conjunto_borrar(hash_conjunto_t *conj, const char *clave);
+
+// Devuelve la cantidad de claves del conjunto.
+size_t hash_conjunto_cantidad(const hash_conjunto_t *conj);
+
+/* Llama a visitar con cada clave, hasta recorrerlas todas o hasta que
+ * visitar devuelva false. No debe modificarse el conjunto mientras.
+ * Pre: El conjunto fue creado
+ */
+void hash_conjunto_iterar(const hash_conjunto_t *conj, bool visitar(const char *clave, void *extra), void *extra);
+
+/* Devuelven un conjunto nuevo con la unión o la intersección de a y b, o
+ * NULL si no hubo memoria. Reutilizan el hash que cada clave ya tiene
+ * guardado, sin volver a calcularlo.
+ * Pre: Los conjuntos fueron creados
+ */
+hash_conjunto_t *hash_conjunto_union(const hash_conjunto_t *a, const hash_conjunto_t *b);
+hash_conjunto_t *hash_conjunto_interseccion(const hash_conjunto_t *a, const hash_conjunto_t *b);
+
+/* Destruye el conjunto.
+ * Pre: El conjunto fue creado
+ */
+void hash_conjunto_destruir(hash_conjunto_t *conj);
+
+#endif // HASH_CONJUNTO_H
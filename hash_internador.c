@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200809L
+#include "hash_internador.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#define CAPACIDAD_INICIAL_INTERNADOR 16
+#define CADENAS_MAXIMAS ((size_t)UINT32_MAX)
+
+/* ids guarda cada cadena con su id más uno como dato, y cadenas tiene en la
+ * posición de cada id la clave que guarda ids, que es la copia internada:
+ * ids nunca borra ni congela sus claves, así que no se mueven. */
+struct hash_internador{
+    hash_t* ids;
+    const char** cadenas;
+    size_t cantidad;
+    size_t capacidad;
+    pthread_rwlock_t lock;
+};
+
+/* Busca la cadena sin tomar el lock */
+const char* buscar_internada(const hash_internador_t* internador, const char* cadena, uint32_t* id){
+    uintptr_t i = (uintptr_t)hash_obtener(internador->ids, cadena);
+    if (!i) return NULL;
+    if (id) *id = (uint32_t)(i - 1);
+    return internador->cadenas[i - 1];
+}
+
+/* Interna la cadena, que no está, con el lock de escritura tomado */
+const char* agregar_internada(hash_internador_t* internador, const char* cadena, uint32_t* id){
+    if (internador->cantidad == CADENAS_MAXIMAS) return NULL;
+    if (internador->cantidad == internador->capacidad){
+        const char** cadenas = realloc(internador->cadenas, internador->capacidad * 2 * sizeof(char*));
+        if (!cadenas) return NULL;
+        internador->cadenas = cadenas;
+        internador->capacidad *= 2;
+    }
+    size_t i = internador->cantidad;
+    if (!hash_guardar(internador->ids, cadena, (void*)(uintptr_t)(i + 1))) return NULL;
+    internador->cadenas[i] = hash_obtener_clave(internador->ids, cadena);
+    internador->cantidad++;
+    if (id) *id = (uint32_t)i;
+    return internador->cadenas[i];
+}
+
+hash_internador_t *hash_internador_crear(void){
+    hash_internador_t* internador = malloc(sizeof(hash_internador_t));
+    if (!internador) return NULL;
+    internador->ids = hash_crear(NULL);
+    internador->cadenas = malloc(CAPACIDAD_INICIAL_INTERNADOR * sizeof(char*));
+    if (!internador->ids || !internador->cadenas || pthread_rwlock_init(&internador->lock, NULL)){
+        if (internador->ids) hash_destruir(internador->ids);
+        free(internador->cadenas);
+        free(internador);
+        return NULL;
+    }
+    internador->cantidad = 0;
+    internador->capacidad = CAPACIDAD_INICIAL_INTERNADOR;
+    return internador;
+}
+
+/* La mayoría de las cadenas ya están internadas, así que primero se la busca
+ * con el lock de lectura, y sólo si no está se toma el de escritura, con el
+ * que hay que volver a buscarla porque otro hilo pudo internarla entre
+ * medio. */
+const char *hash_internar(hash_internador_t *internador, const char *cadena, uint32_t *id){
+    pthread_rwlock_rdlock(&internador->lock);
+    const char* internada = buscar_internada(internador, cadena, id);
+    pthread_rwlock_unlock(&internador->lock);
+    if (internada) return internada;
+
+    pthread_rwlock_wrlock(&internador->lock);
+    internada = buscar_internada(internador, cadena, id);
+    if (!internada) internada = agregar_internada(internador, cadena, id);
+    pthread_rwlock_unlock(&internador->lock);
+    return internada;
+}
+
+const char *hash_internador_buscar(hash_internador_t *internador, const char *cadena, uint32_t *id){
+    pthread_rwlock_rdlock(&internador->lock);
+    const char* internada = buscar_internada(internador, cadena, id);
+    pthread_rwlock_unlock(&internador->lock);
+    return internada;
+}
+
+const char *hash_internador_cadena(hash_internador_t *internador, uint32_t id){
+    pthread_rwlock_rdlock(&internador->lock);
+    const char* cadena = id < internador->cantidad ? internador->cadenas[id] : NULL;
+    pthread_rwlock_unlock(&internador->lock);
+    return cadena;
+}
+
+size_t hash_internador_cantidad(hash_internador_t *internador){
+    pthread_rwlock_rdlock(&internador->lock);
+    size_t cantidad = internador->cantidad;
+    pthread_rwlock_unlock(&internador->lock);
+    return cantidad;
+}
+
+void hash_internador_destruir(hash_internador_t *internador){
+    pthread_rwlock_destroy(&internador->lock);
+    hash_destruir(internador->ids);
+    free(internador->cadenas);
+    free(internador);
+}
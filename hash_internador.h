@@ -0,0 +1,49 @@
+#ifndef HASH_INTERNADOR_H
+#define HASH_INTERNADOR_H
+
+#include "hash.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Internador de cadenas: guarda una única copia de cada cadena y le asigna
+ * un id, empezando de 0 y consecutivos en el orden en que se internan. La
+ * copia y el id no cambian mientras exista el internador, por lo que dos
+ * cadenas internadas son iguales si y sólo si lo son sus punteros o sus ids.
+ * Los hashes que usan un internador (ver hash_usar_internador) guardan ahí
+ * sus claves en lugar de copiarlas.
+ * Todas las funciones pueden llamarse a la vez desde varios hilos: las
+ * consultas se hacen en paralelo, e internar una cadena nueva las bloquea
+ * mientras dura. hash_internador_t está declarado en hash.h. */
+
+/* Crea el internador, o devuelve NULL si no hubo memoria.
+ */
+hash_internador_t *hash_internador_crear(void);
+
+/* Devuelve la copia internada de la cadena, internándola si no estaba, y
+ * guarda su id en id si no es NULL. Devuelve NULL si no hubo memoria o si ya
+ * hay 2^32 - 1 cadenas.
+ * Pre: El internador fue creado
+ */
+const char *hash_internar(hash_internador_t *internador, const char *cadena, uint32_t *id);
+
+/* Devuelve la copia internada de la cadena y guarda su id en id si no es
+ * NULL, o devuelve NULL si la cadena no está internada.
+ * Pre: El internador fue creado
+ */
+const char *hash_internador_buscar(hash_internador_t *internador, const char *cadena, uint32_t *id);
+
+/* Devuelve la cadena internada con el id, o NULL si no hay.
+ * Pre: El internador fue creado
+ */
+const char *hash_internador_cadena(hash_internador_t *internador, uint32_t id);
+
+// Devuelve la cantidad de cadenas internadas.
+size_t hash_internador_cantidad(hash_internador_t *internador);
+
+/* Destruye el internador y sus cadenas.
+ * Pre: El internador fue creado, y ningún hash lo usa
+ */
+void hash_internador_destruir(hash_internador_t *internador);
+
+#endif // HASH_INTERNADOR_H
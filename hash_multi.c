@@ -0,0 +1,126 @@
+#include "hash_multi.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#define CAPACIDAD_CORRIDA 2
+
+/* Los datos de cada clave se guardan en una corrida: un único bloque con
+ * los punteros consecutivos, que se duplica al llenarse. El hash guarda la
+ * corrida como dato, así una clave con n datos cuesta una sola entrada del
+ * hash y una reserva de memoria, en vez de una lista_t con un nodo por
+ * dato. */
+typedef struct corrida{
+    size_t cant;
+    size_t capacidad;
+    void* datos[];
+} corrida_t;
+
+struct hash_multi{
+    hash_t* hash;
+    size_t cant_datos;
+    hash_destruir_dato_t destruir_dato;
+};
+
+hash_multi_t *hash_multi_crear(hash_destruir_dato_t destruir_dato){
+    hash_multi_t* multi = malloc(sizeof(hash_multi_t));
+    if (!multi) return NULL;
+    multi->hash = hash_crear(NULL);
+    if (!multi->hash){
+        free(multi);
+        return NULL;
+    }
+    multi->cant_datos = 0;
+    multi->destruir_dato = destruir_dato;
+    return multi;
+}
+
+bool hash_multi_agregar(hash_multi_t *multi, const char *clave, void *dato){
+    void** lugar;
+    bool insertada;
+    if (!hash_obtener_o_insertar(multi->hash, clave, &lugar, &insertada)) return false;
+    corrida_t* corrida = *lugar;
+    if (!corrida || corrida->cant == corrida->capacidad){
+        size_t capacidad = corrida ? corrida->capacidad * 2 : CAPACIDAD_CORRIDA;
+        corrida_t* nueva = realloc(corrida, sizeof(corrida_t) + capacidad * sizeof(void*));
+        if (!nueva){
+            if (insertada) hash_borrar(multi->hash, clave);
+            return false;
+        }
+        if (!corrida) nueva->cant = 0;
+        nueva->capacidad = capacidad;
+        corrida = nueva;
+        *lugar = corrida;
+    }
+    corrida->datos[corrida->cant++] = dato;
+    multi->cant_datos++;
+    return true;
+}
+
+void *const *hash_multi_obtener(const hash_multi_t *multi, const char *clave, size_t *cantidad){
+    corrida_t* corrida = hash_obtener(multi->hash, clave);
+    *cantidad = corrida ? corrida->cant : 0;
+    return corrida ? corrida->datos : NULL;
+}
+
+bool hash_multi_pertenece(const hash_multi_t *multi, const char *clave){
+    return hash_pertenece(multi->hash, clave);
+}
+
+bool hash_multi_borrar_dato(hash_multi_t *multi, const char *clave, const void *dato){
+    size_t h = hash_calcular(clave);
+    corrida_t* corrida = hash_obtener_con_hash(multi->hash, clave, h);
+    if (!corrida) return false;
+    size_t i = 0;
+    while (i < corrida->cant && corrida->datos[i] != dato) i++;
+    if (i == corrida->cant) return false;
+    corrida->cant--;
+    memmove(&corrida->datos[i], &corrida->datos[i + 1], (corrida->cant - i) * sizeof(void*));
+    multi->cant_datos--;
+    if (!corrida->cant) free(hash_borrar_con_hash(multi->hash, clave, h));
+    return true;
+}
+
+size_t hash_multi_borrar(hash_multi_t *multi, const char *clave){
+    corrida_t* corrida = hash_borrar(multi->hash, clave);
+    if (!corrida) return 0;
+    size_t cant = corrida->cant;
+    if (multi->destruir_dato){
+        for (size_t i = 0; i < cant; i++) multi->destruir_dato(corrida->datos[i]);
+    }
+    free(corrida);
+    multi->cant_datos -= cant;
+    return cant;
+}
+
+size_t hash_multi_cantidad(const hash_multi_t *multi){
+    return hash_cantidad(multi->hash);
+}
+
+size_t hash_multi_cantidad_datos(const hash_multi_t *multi){
+    return multi->cant_datos;
+}
+
+void hash_multi_iterar(const hash_multi_t *multi, bool visitar(const char *clave, void *const *datos, size_t cantidad, void *extra), void *extra){
+    hash_iter_t* iter = hash_iter_crear(multi->hash);
+    if (!iter) return;
+    while (!hash_iter_al_final(iter)){
+        corrida_t* corrida = hash_iter_ver_dato(iter);
+        if (!visitar(hash_iter_ver_actual(iter), corrida->datos, corrida->cant, extra)) break;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+}
+
+void hash_multi_destruir(hash_multi_t *multi){
+    hash_iter_t* iter = hash_iter_crear(multi->hash);
+    while (iter && !hash_iter_al_final(iter)){
+        corrida_t* corrida = hash_iter_ver_dato(iter);
+        for (size_t i = 0; multi->destruir_dato && i < corrida->cant; i++) multi->destruir_dato(corrida->datos[i]);
+        free(corrida);
+        hash_iter_avanzar(iter);
+    }
+    if (iter) hash_iter_destruir(iter);
+    hash_destruir(multi->hash);
+    free(multi);
+}
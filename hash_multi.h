@@ -0,0 +1,66 @@
+#ifndef HASH_MULTI_H
+#define HASH_MULTI_H
+
+#include "hash.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Hash que asocia a cada clave una secuencia de datos, guardados
+ * consecutivos en un único arreglo por clave. */
+struct hash_multi;
+
+typedef struct hash_multi hash_multi_t;
+
+/* Crea el hash. La función destruir_dato se llama sobre cada dato que se
+ * borra con hash_multi_borrar o que queda en el hash al destruirlo.
+ */
+hash_multi_t *hash_multi_crear(hash_destruir_dato_t destruir_dato);
+
+/* Agrega el dato al final de los datos de la clave, aunque ya estuviera.
+ * Devuelve false si no se pudo agregar.
+ * Pre: El hash fue creado
+ */
+bool hash_multi_agregar(hash_multi_t *multi, const char *clave, void *dato);
+
+/* Devuelve los datos de la clave en el orden en que se agregaron, y guarda
+ * su cantidad en cantidad, o devuelve NULL si la clave no está. El arreglo
+ * es válido hasta la próxima modificación de la clave.
+ * Pre: El hash fue creado
+ */
+void *const *hash_multi_obtener(const hash_multi_t *multi, const char *clave, size_t *cantidad);
+
+/* Determina si la clave tiene algún dato.
+ * Pre: El hash fue creado
+ */
+bool hash_multi_pertenece(const hash_multi_t *multi, const char *clave);
+
+/* Quita la primera aparición del dato entre los datos de la clave, sin
+ * destruirlo, y quita la clave si era su único dato. Devuelve false si no
+ * estaba.
+ * Pre: El hash fue creado
+ */
+bool hash_multi_borrar_dato(hash_multi_t *multi, const char *clave, const void *dato);
+
+/* Quita la clave destruyendo todos sus datos, y devuelve cuántos tenía.
+ * Pre: El hash fue creado
+ */
+size_t hash_multi_borrar(hash_multi_t *multi, const char *clave);
+
+// Devuelve la cantidad de claves del hash.
+size_t hash_multi_cantidad(const hash_multi_t *multi);
+
+// Devuelve la cantidad total de datos del hash.
+size_t hash_multi_cantidad_datos(const hash_multi_t *multi);
+
+/* Llama a visitar con cada clave y sus datos, hasta recorrerlas todas o
+ * hasta que visitar devuelva false. No debe modificarse el hash mientras.
+ * Pre: El hash fue creado
+ */
+void hash_multi_iterar(const hash_multi_t *multi, bool visitar(const char *clave, void *const *datos, size_t cantidad, void *extra), void *extra);
+
+/* Destruye el hash llamando a destruir_dato para cada dato.
+ * Pre: El hash fue creado
+ */
+void hash_multi_destruir(hash_multi_t *multi);
+
+#endif // HASH_MULTI_H
@@ -5,9 +5,23 @@
  * Licencia: CC-BY-SA 2.5 (ar) ó CC-BY-SA 3.0
  */
 
+#define _POSIX_C_SOURCE 200809L
+#include "cola_concurrente.h"
 #include "hash.h"
+#include "hash_abierto.h"
+#include "hash_cache.h"
+#include "hash_compacto.h"
+#include "hash_conjunto.h"
+#include "hash_internador.h"
+#include "hash_multi.h"
+#include "hash_registro.h"
+#include "memoria.h"
 #include "testing.h"
 
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -209,6 +223,1220 @@ static void prueba_hash_valor_null()
     hash_destruir(hash);
 }
 
+static void prueba_hash_obtener_o_insertar()
+{
+    hash_t* hash = hash_crear(NULL);
+
+    char *clave1 = "perro", *valor1 = "guau", *valor2 = "warf";
+    void **dato = NULL;
+    bool insertado = false;
+
+    /* La primera vez inserta la clave con valor NULL */
+    print_test("Prueba hash obtener o insertar clave1", hash_obtener_o_insertar(hash, clave1, &dato, &insertado));
+    print_test("Prueba hash obtener o insertar clave1, fue insertada", insertado);
+    print_test("Prueba hash obtener o insertar clave1, el valor es NULL", dato && !*dato);
+    print_test("Prueba hash la cantidad de elementos es 1", hash_cantidad(hash) == 1);
+    *dato = valor1;
+    print_test("Prueba hash obtener clave1 es valor1", hash_obtener(hash, clave1) == valor1);
+
+    /* La segunda vez devuelve el mismo valor sin insertar */
+    print_test("Prueba hash obtener o insertar clave1 de nuevo", hash_obtener_o_insertar(hash, clave1, &dato, &insertado));
+    print_test("Prueba hash obtener o insertar clave1, no fue insertada", !insertado);
+    print_test("Prueba hash obtener o insertar clave1, el valor es valor1", *dato == valor1);
+    *dato = valor2;
+    print_test("Prueba hash obtener clave1 es valor2", hash_obtener(hash, clave1) == valor2);
+    print_test("Prueba hash la cantidad de elementos es 1", hash_cantidad(hash) == 1);
+
+    hash_destruir(hash);
+}
+
+static void *sumar_uno(void *dato, bool existia, void *extra)
+{
+    size_t *contador = dato;
+    if (!existia) {
+        contador = malloc(sizeof(size_t));
+        if (!contador) return NULL;
+        *contador = 0;
+    }
+    (*contador)++;
+    (*(size_t*) extra)++;
+    return contador;
+}
+
+static void prueba_hash_actualizar()
+{
+    hash_t* hash = hash_crear(free);
+
+    char *claves[] = {"perro", "gato", "perro", "vaca", "perro", "gato"};
+    size_t llamadas = 0;
+
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(claves) / sizeof(char *); i++) {
+        ok &= hash_actualizar(hash, claves[i], sumar_uno, &llamadas);
+    }
+    print_test("Prueba hash actualizar varias claves", ok);
+    print_test("Prueba hash actualizar llamo a la funcion una vez por clave", llamadas == 6);
+    print_test("Prueba hash la cantidad de elementos es 3", hash_cantidad(hash) == 3);
+    print_test("Prueba hash el contador de perro es 3", *(size_t*) hash_obtener(hash, "perro") == 3);
+    print_test("Prueba hash el contador de gato es 2", *(size_t*) hash_obtener(hash, "gato") == 2);
+    print_test("Prueba hash el contador de vaca es 1", *(size_t*) hash_obtener(hash, "vaca") == 1);
+
+    hash_destruir(hash);
+}
+
+static void prueba_hash_con_hash()
+{
+    hash_t* hash1 = hash_crear(NULL);
+    hash_t* hash2 = hash_crear(NULL);
+
+    char *clave = "perro", *valor1 = "guau", *valor2 = "warf";
+    size_t h = hash_calcular(clave);
+
+    /* El mismo hash precalculado sirve para ambos hashes */
+    print_test("Prueba hash calcular es determinístico", h == hash_calcular("perro"));
+    print_test("Prueba hash guardar con hash en hash1", hash_guardar_con_hash(hash1, clave, h, valor1));
+    print_test("Prueba hash guardar con hash en hash2", hash_guardar_con_hash(hash2, clave, h, valor2));
+    print_test("Prueba hash obtener clave en hash1 es valor1", hash_obtener(hash1, clave) == valor1);
+    print_test("Prueba hash obtener con hash en hash2 es valor2", hash_obtener_con_hash(hash2, clave, h) == valor2);
+    print_test("Prueba hash pertenece con hash en hash1, es true", hash_pertenece_con_hash(hash1, clave, h));
+    print_test("Prueba hash borrar con hash en hash1 es valor1", hash_borrar_con_hash(hash1, clave, h) == valor1);
+    print_test("Prueba hash pertenece con hash en hash1, es false", !hash_pertenece_con_hash(hash1, clave, h));
+    print_test("Prueba hash pertenece clave en hash2, es true", hash_pertenece(hash2, clave));
+
+    hash_destruir(hash1);
+    hash_destruir(hash2);
+}
+
+static void prueba_hash_cache()
+{
+    hash_cache_t* cache = hash_cache_crear(3, 100, NULL);
+
+    char *claves[] = {"perro", "gato", "vaca", "pato"};
+    char *valores[] = {"guau", "miau", "mu", "cuac"};
+
+    print_test("Prueba hash cache crear", cache);
+    print_test("Prueba hash cache guardar clave1", hash_cache_guardar(cache, claves[0], valores[0], 10));
+    print_test("Prueba hash cache guardar clave2", hash_cache_guardar(cache, claves[1], valores[1], 10));
+    print_test("Prueba hash cache guardar clave3", hash_cache_guardar(cache, claves[2], valores[2], 10));
+    print_test("Prueba hash cache la cantidad de entradas es 3", hash_cache_cantidad(cache) == 3);
+    print_test("Prueba hash cache los bytes son 30", hash_cache_bytes(cache) == 30);
+
+    /* Usar clave1 hace que la menos reciente sea clave2 */
+    print_test("Prueba hash cache obtener clave1 es valor1", hash_cache_obtener(cache, claves[0]) == valores[0]);
+    print_test("Prueba hash cache guardar clave4", hash_cache_guardar(cache, claves[3], valores[3], 10));
+    print_test("Prueba hash cache la cantidad de entradas es 3", hash_cache_cantidad(cache) == 3);
+    print_test("Prueba hash cache clave2 fue descartada", !hash_cache_pertenece(cache, claves[1]));
+    print_test("Prueba hash cache clave1 sigue", hash_cache_pertenece(cache, claves[0]));
+    print_test("Prueba hash cache obtener clave2 es NULL", !hash_cache_obtener(cache, claves[1]));
+
+    /* Reemplazar una entrada por una más grande descarta por bytes */
+    print_test("Prueba hash cache reemplazar clave1 con 85 bytes", hash_cache_guardar(cache, claves[0], valores[1], 85));
+    print_test("Prueba hash cache obtener clave1 es valor2", hash_cache_obtener(cache, claves[0]) == valores[1]);
+    print_test("Prueba hash cache los bytes no superan el maximo", hash_cache_bytes(cache) <= 100);
+    print_test("Prueba hash cache la cantidad de entradas es 2", hash_cache_cantidad(cache) == 2);
+    print_test("Prueba hash cache no guarda un dato mayor al maximo", !hash_cache_guardar(cache, claves[1], valores[1], 101));
+
+    print_test("Prueba hash cache los aciertos son 2", hash_cache_aciertos(cache) == 2);
+    print_test("Prueba hash cache los fallos son 1", hash_cache_fallos(cache) == 1);
+    print_test("Prueba hash cache borrar clave1 es valor2", hash_cache_borrar(cache, claves[0]) == valores[1]);
+    print_test("Prueba hash cache la cantidad de entradas es 1", hash_cache_cantidad(cache) == 1);
+
+    hash_cache_destruir(cache);
+}
+
+static void prueba_hash_vencimientos()
+{
+    hash_t* hash = hash_crear(free);
+
+    char *clave1 = "perro", *clave2 = "gato", *clave3 = "vaca";
+    int *valor1 = malloc(sizeof(int)), *valor2 = malloc(sizeof(int)), *valor3 = malloc(sizeof(int));
+
+    print_test("Prueba hash guardar clave1 con ttl 10", hash_guardar_con_ttl(hash, clave1, valor1, 100, 10));
+    print_test("Prueba hash guardar clave2 con ttl 20", hash_guardar_con_ttl(hash, clave2, valor2, 100, 20));
+    print_test("Prueba hash guardar clave3 sin ttl", hash_guardar(hash, clave3, valor3));
+    print_test("Prueba hash obtener clave1 antes de vencer es valor1", hash_obtener(hash, clave1) == valor1);
+
+    /* Sin presupuesto sólo avanza el instante: clave1 vence pero no se libera */
+    print_test("Prueba hash expirar sin presupuesto no libera", hash_expirar(hash, 110, 0) == 0);
+    print_test("Prueba hash obtener clave1 vencida es NULL", !hash_obtener(hash, clave1));
+    print_test("Prueba hash pertenece clave1 vencida, es false", !hash_pertenece(hash, clave1));
+    print_test("Prueba hash obtener clave2 es valor2", hash_obtener(hash, clave2) == valor2);
+    print_test("Prueba hash la cantidad de elementos es 3", hash_cantidad(hash) == 3);
+
+    print_test("Prueba hash expirar libera clave1", hash_expirar(hash, 110, 100) == 1);
+    print_test("Prueba hash la cantidad de elementos es 2", hash_cantidad(hash) == 2);
+
+    /* Renovar el vencimiento de clave2 evita que venza */
+    valor1 = malloc(sizeof(int));
+    print_test("Prueba hash renovar clave2 con ttl 50", hash_guardar_con_ttl(hash, clave2, valor1, 115, 50));
+    print_test("Prueba hash expirar en 130 no libera nada", hash_expirar(hash, 130, 100) == 0);
+    print_test("Prueba hash obtener clave2 es el nuevo valor", hash_obtener(hash, clave2) == valor1);
+    print_test("Prueba hash expirar mucho despues libera clave2", hash_expirar(hash, 10000, 100) == 1);
+    print_test("Prueba hash obtener clave3 sin ttl es valor3", hash_obtener(hash, clave3) == valor3);
+    print_test("Prueba hash la cantidad de elementos es 1", hash_cantidad(hash) == 1);
+
+    hash_destruir(hash);
+}
+
+static bool contar_visitados(const char *clave, void *dato, void *extra)
+{
+    (void)clave;
+    (void)dato;
+    (*(size_t*)extra)++;
+    return true;
+}
+
+static void prueba_hash_instantanea(size_t largo)
+{
+    hash_t* hash = hash_crear(free);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+
+    bool ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08d", i);
+        int *valor = malloc(sizeof(int));
+        *valor = (int)i;
+        ok &= hash_guardar(hash, claves[i], valor);
+    }
+    print_test("Prueba hash instantanea, se insertaron los elementos", ok);
+
+    hash_instantanea_t* inst = hash_instantanea_crear(hash);
+    print_test("Prueba hash instantanea crear", inst);
+
+    /* Los datos que devuelve hash_borrar pueden seguir visibles en la
+     * instantánea: se liberan después de destruirla */
+    int **borrados = malloc(largo * sizeof(int*));
+
+    /* Borra la mitad, reemplaza el resto y agrega otros tantos, forzando
+     * redimensiones mientras existe la instantánea */
+    for (unsigned i = 0; i < largo; i++) {
+        if (i % 2 == 0) {
+            borrados[i / 2] = hash_borrar(hash, claves[i]);
+        } else {
+            int *valor = malloc(sizeof(int));
+            *valor = -1;
+            hash_guardar(hash, claves[i], valor);
+        }
+    }
+    for (unsigned i = 0; i < largo; i++) {
+        char clave[largo_clave + 1];
+        sprintf(clave, "n%08d", i);
+        hash_guardar(hash, clave, malloc(sizeof(int)));
+    }
+    print_test("Prueba hash instantanea, la cantidad del hash es la esperada", hash_cantidad(hash) == largo + largo / 2);
+    print_test("Prueba hash instantanea, la cantidad de la instantanea no cambio", hash_instantanea_cantidad(inst) == largo);
+
+    ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        int *valor = hash_instantanea_obtener(inst, claves[i]);
+        ok &= valor && *valor == (int)i && hash_instantanea_pertenece(inst, claves[i]);
+    }
+    print_test("Prueba hash instantanea, ve los valores originales", ok);
+    print_test("Prueba hash instantanea, no ve las claves nuevas", !hash_instantanea_pertenece(inst, "n00000000"));
+
+    size_t visitados = 0;
+    hash_instantanea_iterar(inst, contar_visitados, &visitados);
+    print_test("Prueba hash instantanea, se recorrieron todos", visitados == largo);
+
+    ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        int *valor = hash_obtener(hash, claves[i]);
+        ok &= (i % 2 == 0) ? !valor : (valor && *valor == -1);
+    }
+    print_test("Prueba hash instantanea, el hash tiene los valores nuevos", ok);
+
+    hash_instantanea_destruir(inst);
+    for (unsigned i = 0; i < (largo + 1) / 2; i++) free(borrados[i]);
+    int *borrado = hash_borrar(hash, "n00000000");
+    print_test("Prueba hash borrar tras destruir la instantanea", borrado != NULL);
+
+    free(borrado);
+    free(borrados);
+    free(claves);
+    hash_destruir(hash);
+}
+
+/* Las instantáneas comparten las fichas de vencimiento con el hash: renovar
+ * o expirar claves en el hash no debe cambiar lo que ve la instantánea */
+static void prueba_hash_instantanea_vencimientos()
+{
+    hash_t* hash = hash_crear(NULL);
+    hash_guardar_con_ttl(hash, "corto", "c", 0, 10);
+    hash_guardar_con_ttl(hash, "largo", "l", 0, 100);
+    hash_instantanea_t* inst = hash_instantanea_crear(hash);
+    print_test("Prueba hash instantanea con vencimientos crear", inst);
+
+    print_test("Prueba hash instantanea renovar largo para que venza ya", hash_guardar_con_ttl(hash, "largo", "L", 0, 0));
+    print_test("Prueba hash instantanea largo vencio en el hash", !hash_pertenece(hash, "largo"));
+    print_test("Prueba hash instantanea sigue viendo largo", hash_instantanea_obtener(inst, "largo") == (void*)"l");
+
+    print_test("Prueba hash instantanea expirar ambas en el hash", hash_expirar(hash, 50, 100) == 2 && hash_cantidad(hash) == 0);
+    size_t visitados = 0;
+    hash_instantanea_iterar(inst, contar_visitados, &visitados);
+    print_test("Prueba hash instantanea sigue viendo las expiradas", visitados == 2 && hash_instantanea_pertenece(inst, "corto"));
+
+    hash_instantanea_destruir(inst);
+    print_test("Prueba hash instantanea con vencimientos expirar tras destruirla", hash_expirar(hash, 60, 100) == 0);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_registro()
+{
+    const char *ruta = "prueba_hash_registro.log";
+    unlink(ruta);
+
+    hash_registro_t* reg = hash_registro_abrir(ruta, 2);
+    print_test("Prueba hash registro abrir vacio", reg && hash_registro_cantidad(reg) == 0);
+    print_test("Prueba hash registro guardar perro", hash_registro_guardar(reg, "perro", "guau", 5));
+    print_test("Prueba hash registro guardar gato", hash_registro_guardar(reg, "gato", "miau", 5));
+    print_test("Prueba hash registro guardar vaca", hash_registro_guardar(reg, "vaca", "mu", 3));
+    print_test("Prueba hash registro reemplazar gato", hash_registro_guardar(reg, "gato", "miauu", 6));
+    print_test("Prueba hash registro borrar vaca", hash_registro_borrar(reg, "vaca"));
+    print_test("Prueba hash registro borrar vaca de nuevo, es false", !hash_registro_borrar(reg, "vaca"));
+    size_t tam_antes = hash_registro_tam(reg);
+    print_test("Prueba hash registro cerrar", hash_registro_cerrar(reg));
+
+    /* Reabrir reconstruye el hash; una escritura cortada al final se descarta */
+    FILE* archivo = fopen(ruta, "ab");
+    fwrite("G\3\0", 1, 3, archivo);
+    fclose(archivo);
+    reg = hash_registro_abrir(ruta, 0);
+    size_t tam = 0;
+    const char *dato = reg ? hash_registro_obtener(reg, "gato", &tam) : NULL;
+    print_test("Prueba hash registro reabrir, la cantidad es 2", reg && hash_registro_cantidad(reg) == 2);
+    print_test("Prueba hash registro reabrir, gato tiene el dato nuevo", dato && tam == 6 && !strcmp(dato, "miauu"));
+    print_test("Prueba hash registro reabrir, vaca no esta", !hash_registro_obtener(reg, "vaca", &tam));
+    print_test("Prueba hash registro reabrir, se descarto lo incompleto", hash_registro_tam(reg) == tam_antes);
+
+    print_test("Prueba hash registro compactar", hash_registro_compactar(reg));
+    print_test("Prueba hash registro compactar achica el archivo", hash_registro_tam(reg) < tam_antes);
+    print_test("Prueba hash registro guardar tras compactar", hash_registro_guardar(reg, "vaca", "muu", 4));
+    print_test("Prueba hash registro cerrar", hash_registro_cerrar(reg));
+
+    reg = hash_registro_abrir(ruta, 1);
+    dato = reg ? hash_registro_obtener(reg, "vaca", &tam) : NULL;
+    print_test("Prueba hash registro reabrir compactado, la cantidad es 3", reg && hash_registro_cantidad(reg) == 3);
+    print_test("Prueba hash registro reabrir compactado, vaca tiene su dato", dato && !strcmp(dato, "muu"));
+    hash_registro_cerrar(reg);
+    unlink(ruta);
+}
+
+static void prueba_hash_congelar_claves(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+
+    const size_t largo_clave = 48;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t valores[largo];
+
+    bool ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "/usr/share/doc/paquete%04u/archivo%u", i / 7, i % 7);
+        valores[i] = i;
+        ok &= hash_guardar(hash, claves[i], &valores[i]);
+    }
+    print_test("Prueba hash congelar, se insertaron los elementos", ok);
+    print_test("Prueba hash congelar claves", hash_congelar_claves(hash));
+
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_obtener(hash, claves[i]) == &valores[i];
+    }
+    print_test("Prueba hash congelar, se obtienen todos los elementos", ok);
+    print_test("Prueba hash congelar, un prefijo de una clave no pertenece", !hash_pertenece(hash, "/usr/share/doc/paquete0000/archivo"));
+    print_test("Prueba hash congelar, una extension de una clave no pertenece", !hash_pertenece(hash, "/usr/share/doc/paquete0000/archivo00"));
+    const char *guardada = hash_obtener_clave(hash, claves[largo / 2]);
+    print_test("Prueba hash congelar, obtener clave la decodifica", guardada && !strcmp(guardada, claves[largo / 2]));
+
+    hash_iter_t* iter = hash_iter_crear(hash);
+    size_t recorridos = 0;
+    ok = true;
+    while (!hash_iter_al_final(iter)) {
+        const char *clave = hash_iter_ver_actual(iter);
+        size_t *valor = hash_obtener(hash, clave);
+        ok &= valor && !strcmp(claves[*valor], clave);
+        recorridos++;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash congelar, el iterador devuelve las claves", ok && recorridos == largo);
+
+    /* Borra claves congeladas y agrega otras nuevas, y vuelve a congelar */
+    ok = true;
+    for (size_t i = 0; i < largo; i += 2) {
+        ok &= hash_borrar(hash, claves[i]) == &valores[i];
+    }
+    ok &= hash_guardar(hash, "/usr/share/doc/nueva", NULL);
+    print_test("Prueba hash congelar, se borran claves congeladas", ok);
+    print_test("Prueba hash congelar de nuevo", hash_congelar_claves(hash));
+    ok = hash_pertenece(hash, "/usr/share/doc/nueva");
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_pertenece(hash, claves[i]) == (i % 2 == 1);
+    }
+    print_test("Prueba hash congelar de nuevo, quedan las claves esperadas", ok);
+    print_test("Prueba hash congelar de nuevo, la cantidad es correcta", hash_cantidad(hash) == largo / 2 + 1);
+
+    free(claves);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_filtro(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+    print_test("Prueba hash filtro activar", hash_filtro_activar(hash, 10));
+
+    char clave[32];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "clave%zu", i);
+        ok &= hash_guardar(hash, clave, NULL);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "clave%zu", i);
+        ok &= hash_pertenece(hash, clave);
+    }
+    print_test("Prueba hash filtro, pertenecen todas las claves guardadas", ok);
+
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "falta%zu", i);
+        ok &= !hash_pertenece(hash, clave);
+    }
+    print_test("Prueba hash filtro, no pertenecen las claves no guardadas", ok);
+    print_test("Prueba hash filtro, se consulto en cada busqueda", hash_filtro_consultas(hash) == 2 * largo);
+    print_test("Prueba hash filtro, descarto la mayoria de los fallos", hash_filtro_descartes(hash) > largo * 9 / 10);
+    print_test("Prueba hash filtro, los falsos positivos son los fallos no descartados",
+               hash_filtro_descartes(hash) + hash_filtro_falsos_positivos(hash) == largo);
+
+    /* Borrar claves que no están también cuenta sus falsos positivos */
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "falta%zu", i);
+        ok &= !hash_borrar(hash, clave);
+    }
+    print_test("Prueba hash filtro, borrar claves no guardadas", ok);
+    print_test("Prueba hash filtro, las consultas son aciertos, descartes o falsos positivos",
+               hash_filtro_consultas(hash) == largo + hash_filtro_descartes(hash) + hash_filtro_falsos_positivos(hash));
+
+    /* Borrar y achicar reconstruye el filtro sin perder claves */
+    ok = true;
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "clave%zu", i);
+        hash_borrar(hash, clave);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "clave%zu", i);
+        ok &= hash_pertenece(hash, clave) == (i % 2 == 1);
+    }
+    print_test("Prueba hash filtro, tras borrar quedan las claves esperadas", ok);
+    print_test("Prueba hash filtro desactivar", hash_filtro_activar(hash, 0));
+    print_test("Prueba hash filtro desactivado no consulta", hash_filtro_consultas(hash) == 0);
+
+    hash_destruir(hash);
+}
+
+static void prueba_hash_indice(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+
+    print_test("Prueba hash indice, sin activar no hay iterador ordenado", !hash_iter_crear_rango(hash, NULL, NULL));
+    char clave[32];
+    bool ok = true;
+    /* La mitad de las claves se guarda antes de activar el índice */
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%s/%05zu", i % 2 ? "impar" : "par", i);
+        ok &= hash_guardar(hash, clave, NULL);
+        if (i == largo / 2) ok &= hash_indice_activar(hash);
+    }
+    print_test("Prueba hash indice activar y guardar", ok);
+
+    hash_iter_t* iter = hash_iter_crear_rango(hash, NULL, NULL);
+    size_t recorridas = 0;
+    char anterior[32] = "";
+    ok = true;
+    while (!hash_iter_al_final(iter)) {
+        const char *actual = hash_iter_ver_actual(iter);
+        ok &= strcmp(anterior, actual) < 0;
+        strcpy(anterior, actual);
+        recorridas++;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash indice, se recorren todas las claves en orden", ok && recorridas == largo);
+
+    iter = hash_iter_crear_prefijo(hash, "impar/");
+    recorridas = 0;
+    ok = true;
+    while (!hash_iter_al_final(iter)) {
+        ok &= !strncmp(hash_iter_ver_actual(iter), "impar/", 6);
+        recorridas++;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash indice, el prefijo recorre sus claves", ok && recorridas == largo / 2);
+
+    iter = hash_iter_crear_rango(hash, "par/00010", "par/00020");
+    recorridas = 0;
+    while (!hash_iter_al_final(iter)) {
+        recorridas++;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash indice, el rango recorre sus claves", recorridas == 5);
+
+    /* Borrar con el iterador ordenado y con hash_borrar mantiene el índice */
+    iter = hash_iter_crear_prefijo(hash, "par/");
+    while (!hash_iter_al_final(iter)) {
+        hash_iter_borrar_actual(iter);
+    }
+    hash_iter_destruir(iter);
+    hash_borrar(hash, "impar/00001");
+    print_test("Prueba hash indice, se borraron las claves pares", hash_cantidad(hash) == largo / 2 - 1);
+    print_test("Prueba hash indice congelar claves", hash_congelar_claves(hash));
+    iter = hash_iter_crear_rango(hash, "impar/00002", NULL);
+    print_test("Prueba hash indice, la primera clave congelada del rango", !strcmp(hash_iter_ver_actual(iter), "impar/00003"));
+    hash_iter_destruir(iter);
+    iter = hash_iter_crear_prefijo(hash, "par/");
+    print_test("Prueba hash indice, no quedan claves pares", hash_iter_al_final(iter));
+    hash_iter_destruir(iter);
+
+    /* Activar el índice sobre claves congeladas las ordena decodificadas */
+    hash_indice_desactivar(hash);
+    print_test("Prueba hash indice activar con claves congeladas", hash_indice_activar(hash));
+    iter = hash_iter_crear_rango(hash, NULL, NULL);
+    strcpy(anterior, "");
+    ok = true;
+    while (!hash_iter_al_final(iter)) {
+        ok &= strcmp(anterior, hash_iter_ver_actual(iter)) < 0;
+        strcpy(anterior, hash_iter_ver_actual(iter));
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash indice, las claves congeladas quedan en orden", ok);
+
+    /* Con una instantánea, el hash copia los segmentos que modifica, y el
+     * índice debe pasar a las copias antes de que se libere la instantánea */
+    hash_instantanea_t* inst = hash_instantanea_crear(hash);
+    ok = inst != NULL;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "otra/%05zu", i);
+        ok &= hash_guardar(hash, clave, NULL);
+    }
+    hash_instantanea_destruir(inst);
+    iter = hash_iter_crear_rango(hash, NULL, NULL);
+    recorridas = 0;
+    while (!hash_iter_al_final(iter)) {
+        ok &= hash_iter_ver_hash(iter) == hash_calcular(hash_iter_ver_actual(iter));
+        recorridas++;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash indice, el hash de cada clave tras copiar los segmentos", ok && recorridas == hash_cantidad(hash));
+
+    hash_destruir(hash);
+}
+
+static void prueba_hash_iter_ver_dato(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+    size_t* valores = malloc(largo * sizeof(size_t));
+    char clave[32];
+    bool ok = hash_indice_activar(hash);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        valores[i] = i;
+        ok &= hash_guardar(hash, clave, &valores[i]);
+    }
+
+    /* El iterador común y el ordenado ven el mismo dato que hash_obtener */
+    hash_iter_t* iteradores[] = {hash_iter_crear(hash), hash_iter_crear_rango(hash, NULL, NULL)};
+    for (size_t k = 0; k < 2; k++) {
+        size_t recorridas = 0;
+        for (; !hash_iter_al_final(iteradores[k]); hash_iter_avanzar(iteradores[k])) {
+            ok &= hash_iter_ver_dato(iteradores[k]) == hash_obtener(hash, hash_iter_ver_actual(iteradores[k]));
+            recorridas++;
+        }
+        ok &= recorridas == largo && !hash_iter_ver_dato(iteradores[k]);
+        hash_iter_destruir(iteradores[k]);
+    }
+    print_test("Prueba hash iter ver dato, es el dato de cada clave", ok);
+
+    free(valores);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_multi(size_t largo)
+{
+    hash_multi_t* multi = hash_multi_crear(free);
+    char clave[32];
+    bool ok = true;
+    /* Cada clave i % 10 recibe largo / 10 datos */
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "clave%zu", i % 10);
+        size_t* dato = malloc(sizeof(size_t));
+        *dato = i;
+        ok &= hash_multi_agregar(multi, clave, dato);
+    }
+    print_test("Prueba hash multi agregar datos repetidos", ok);
+    print_test("Prueba hash multi la cantidad de claves es 10", hash_multi_cantidad(multi) == 10);
+    print_test("Prueba hash multi la cantidad de datos es correcta", hash_multi_cantidad_datos(multi) == largo);
+
+    size_t cantidad;
+    void *const *datos = hash_multi_obtener(multi, "clave3", &cantidad);
+    ok = datos && cantidad == largo / 10;
+    for (size_t i = 0; ok && i < cantidad; i++) ok = *(size_t*)datos[i] == i * 10 + 3;
+    print_test("Prueba hash multi obtener devuelve los datos en orden", ok);
+    print_test("Prueba hash multi obtener clave inexistente es NULL", !hash_multi_obtener(multi, "otra", &cantidad) && cantidad == 0);
+
+    void* primero = datos[0];
+    print_test("Prueba hash multi borrar un dato", hash_multi_borrar_dato(multi, "clave3", primero));
+    print_test("Prueba hash multi borrar un dato que ya no está es false", !hash_multi_borrar_dato(multi, "clave3", primero));
+    free(primero);
+    datos = hash_multi_obtener(multi, "clave3", &cantidad);
+    print_test("Prueba hash multi quedan los otros datos", cantidad == largo / 10 - 1 && *(size_t*)datos[0] == 13);
+
+    print_test("Prueba hash multi borrar la clave destruye sus datos", hash_multi_borrar(multi, "clave5") == largo / 10);
+    print_test("Prueba hash multi la clave borrada no pertenece", !hash_multi_pertenece(multi, "clave5"));
+
+    size_t* unico = malloc(sizeof(size_t));
+    hash_multi_agregar(multi, "unico", unico);
+    print_test("Prueba hash multi borrar el único dato quita la clave", hash_multi_borrar_dato(multi, "unico", unico) && !hash_multi_pertenece(multi, "unico"));
+    free(unico);
+
+    hash_multi_destruir(multi);
+}
+
+static bool contar_claves(const char *clave, void *extra)
+{
+    (void)clave;
+    (*(size_t*)extra)++;
+    return true;
+}
+
+static void prueba_hash_conjunto(size_t largo)
+{
+    hash_conjunto_t* multiplos2 = hash_conjunto_crear();
+    hash_conjunto_t* multiplos3 = hash_conjunto_crear();
+    char clave[32];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        if (i % 2 == 0) ok &= hash_conjunto_agregar(multiplos2, clave);
+        if (i % 3 == 0) ok &= hash_conjunto_agregar(multiplos3, clave);
+    }
+    ok &= hash_conjunto_agregar(multiplos2, "0");
+    print_test("Prueba hash conjunto agregar claves", ok);
+    print_test("Prueba hash conjunto agregar una repetida no cambia la cantidad", hash_conjunto_cantidad(multiplos2) == (largo + 1) / 2);
+    print_test("Prueba hash conjunto pertenece", hash_conjunto_pertenece(multiplos3, "3") && !hash_conjunto_pertenece(multiplos3, "4"));
+
+    hash_conjunto_t* uni = hash_conjunto_union(multiplos2, multiplos3);
+    hash_conjunto_t* inter = hash_conjunto_interseccion(multiplos2, multiplos3);
+    size_t esperada_uni = 0, esperada_inter = 0;
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 2 == 0 || i % 3 == 0) esperada_uni++;
+        if (i % 6 == 0) esperada_inter++;
+    }
+    print_test("Prueba hash conjunto union tiene la cantidad correcta", hash_conjunto_cantidad(uni) == esperada_uni);
+    print_test("Prueba hash conjunto interseccion tiene la cantidad correcta", hash_conjunto_cantidad(inter) == esperada_inter);
+    print_test("Prueba hash conjunto interseccion tiene los multiplos de 6", hash_conjunto_pertenece(inter, "12") && !hash_conjunto_pertenece(inter, "9"));
+
+    size_t visitadas = 0;
+    hash_conjunto_iterar(inter, contar_claves, &visitadas);
+    print_test("Prueba hash conjunto iterar visita todas las claves", visitadas == esperada_inter);
+
+    print_test("Prueba hash conjunto borrar", hash_conjunto_borrar(uni, "2") && !hash_conjunto_borrar(uni, "2"));
+    print_test("Prueba hash conjunto la clave borrada no pertenece", !hash_conjunto_pertenece(uni, "2"));
+
+    hash_conjunto_destruir(uni);
+    hash_conjunto_destruir(inter);
+    hash_conjunto_destruir(multiplos2);
+    hash_conjunto_destruir(multiplos3);
+}
+
+static void prueba_hash_fusionar(size_t largo)
+{
+    hash_t* destino = hash_crear(free);
+    hash_t* origen = hash_crear(free);
+    char clave[32];
+    bool ok = true;
+    /* Las claves de 0 a largo van a destino y las de largo/2 a 3*largo/2 a
+     * origen; cada dato guarda el número del hash donde se guardó */
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        size_t* dato = malloc(sizeof(size_t));
+        *dato = 1;
+        ok &= hash_guardar(destino, clave, dato);
+        sprintf(clave, "%zu", i + largo / 2);
+        dato = malloc(sizeof(size_t));
+        *dato = 2;
+        ok &= hash_guardar(origen, clave, dato);
+    }
+    hash_indice_activar(destino);
+    hash_filtro_activar(destino, 8);
+    ok &= hash_congelar_claves(origen);
+    ok &= hash_guardar_con_ttl(origen, "vence", malloc(1), 0, 10);
+    print_test("Prueba hash fusionar, guardar en ambos hashes", ok);
+
+    hash_instantanea_t* inst = hash_instantanea_crear(origen);
+    print_test("Prueba hash fusionar con instantaneas de origen falla", !hash_fusionar(destino, origen, HASH_USAR_ORIGEN));
+    hash_instantanea_destruir(inst);
+
+    print_test("Prueba hash fusionar conservando destino", hash_fusionar(destino, origen, HASH_CONSERVAR_DESTINO));
+    print_test("Prueba hash fusionar, origen queda vacio", hash_cantidad(origen) == 0 && !hash_pertenece(origen, "0"));
+    print_test("Prueba hash fusionar, destino tiene todas las claves", hash_cantidad(destino) == largo + largo / 2 + 1);
+    sprintf(clave, "%zu", largo / 2);
+    print_test("Prueba hash fusionar, la clave repetida conserva el dato de destino", *(size_t*)hash_obtener(destino, clave) == 1);
+    sprintf(clave, "%zu", largo);
+    print_test("Prueba hash fusionar, la clave congelada de origen se movio", hash_pertenece(destino, clave) && !strcmp(hash_obtener_clave(destino, clave), clave));
+    hash_expirar(destino, 10, 10);
+    print_test("Prueba hash fusionar, se conserva el vencimiento", !hash_pertenece(destino, "vence"));
+
+    hash_iter_t* iter = hash_iter_crear_rango(destino, NULL, NULL);
+    size_t recorridas = 0;
+    while (!hash_iter_al_final(iter)) {
+        recorridas++;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash fusionar, el indice de destino tiene las claves movidas", recorridas == hash_cantidad(destino));
+
+    size_t* dato = malloc(sizeof(size_t));
+    *dato = 2;
+    hash_guardar(origen, "0", dato);
+    print_test("Prueba hash fusionar usando origen", hash_fusionar(destino, origen, HASH_USAR_ORIGEN));
+    print_test("Prueba hash fusionar, la clave repetida tiene el dato de origen", *(size_t*)hash_obtener(destino, "0") == 2);
+
+    hash_destruir(destino);
+    hash_destruir(origen);
+}
+
+/* Con varios hilos, contar_cambio se llama concurrentemente */
+typedef struct cambios {
+    atomic_size_t agregadas;
+    atomic_size_t quitadas;
+    atomic_size_t cambiadas;
+} cambios_t;
+
+static bool contar_cambio(const char *clave, hash_cambio_t cambio, void *dato_viejo, void *dato_nuevo, void *extra)
+{
+    (void)clave;
+    (void)dato_viejo;
+    (void)dato_nuevo;
+    cambios_t* cambios = extra;
+    if (cambio == HASH_AGREGADA) atomic_fetch_add(&cambios->agregadas, 1);
+    if (cambio == HASH_QUITADA) atomic_fetch_add(&cambios->quitadas, 1);
+    if (cambio == HASH_CAMBIADA) atomic_fetch_add(&cambios->cambiadas, 1);
+    return true;
+}
+
+static bool contar_primer_cambio(const char *clave, hash_cambio_t cambio, void *dato_viejo, void *dato_nuevo, void *extra)
+{
+    (void)clave;
+    (void)cambio;
+    (void)dato_viejo;
+    (void)dato_nuevo;
+    (*(size_t*)extra)++;
+    return false;
+}
+
+static bool mismo_numero(const void *a, const void *b)
+{
+    return *(const size_t*)a == *(const size_t*)b;
+}
+
+static void prueba_hash_diferencia(size_t largo)
+{
+    hash_t* viejo = hash_crear(free);
+    hash_t* nuevo = hash_crear(free);
+    char clave[32];
+    /* nuevo no tiene los múltiplos de 5, y tiene otro número en los de 7 */
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        size_t* dato = malloc(sizeof(size_t));
+        *dato = i;
+        hash_guardar(viejo, clave, dato);
+        if (i % 5 == 0) continue;
+        dato = malloc(sizeof(size_t));
+        *dato = i % 7 ? i : i + 1;
+        hash_guardar(nuevo, clave, dato);
+    }
+    hash_guardar(nuevo, "agregada", malloc(sizeof(size_t)));
+    size_t quitadas = (largo + 4) / 5, cambiadas = 0;
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 5 && i % 7 == 0) cambiadas++;
+    }
+
+    cambios_t cambios = {0, 0, 0};
+    print_test("Prueba hash diferencia", hash_diferencia(viejo, nuevo, mismo_numero, contar_cambio, &cambios, 1));
+    print_test("Prueba hash diferencia, claves agregadas", cambios.agregadas == 1);
+    print_test("Prueba hash diferencia, claves quitadas", cambios.quitadas == quitadas);
+    print_test("Prueba hash diferencia, claves cambiadas", cambios.cambiadas == cambiadas);
+
+    cambios = (cambios_t){0, 0, 0};
+    hash_congelar_claves(viejo);
+    print_test("Prueba hash diferencia con 4 hilos y claves congeladas", hash_diferencia(viejo, nuevo, mismo_numero, contar_cambio, &cambios, 4));
+    print_test("Prueba hash diferencia con 4 hilos, mismos cambios", cambios.agregadas == 1 && cambios.quitadas == quitadas && cambios.cambiadas == cambiadas);
+
+    cambios = (cambios_t){0, 0, 0};
+    hash_diferencia(viejo, nuevo, NULL, contar_cambio, &cambios, 1);
+    print_test("Prueba hash diferencia sin iguales compara punteros", cambios.cambiadas == largo - quitadas);
+
+    size_t visitadas = 0;
+    hash_diferencia(viejo, nuevo, NULL, contar_primer_cambio, &visitadas, 1);
+    print_test("Prueba hash diferencia se detiene si visitar devuelve false", visitadas == 1);
+
+    hash_destruir(viejo);
+    hash_destruir(nuevo);
+}
+
+static void prueba_hash_abierto(size_t largo)
+{
+    hash_abierto_t* hash = hash_abierto_crear(free);
+    char clave[32];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        size_t* dato = malloc(sizeof(size_t));
+        *dato = i;
+        ok &= hash_abierto_guardar(hash, clave, dato);
+    }
+    print_test("Prueba hash abierto guardar muchos elementos", ok);
+    print_test("Prueba hash abierto la cantidad es correcta", hash_abierto_cantidad(hash) == largo);
+
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        size_t* dato = hash_abierto_obtener(hash, clave);
+        ok &= dato && *dato == i;
+    }
+    print_test("Prueba hash abierto obtener cada elemento", ok);
+    print_test("Prueba hash abierto clave inexistente", !hash_abierto_pertenece(hash, "no esta") && !hash_abierto_obtener(hash, "no esta"));
+
+    size_t* dato = malloc(sizeof(size_t));
+    *dato = largo;
+    print_test("Prueba hash abierto reemplazar", hash_abierto_guardar(hash, "00000000", dato) && *(size_t*)hash_abierto_obtener(hash, "00000000") == largo);
+
+    /* Borrar y volver a guardar deja ranuras borradas en el camino */
+    ok = true;
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "%08zu", i);
+        free(hash_abierto_borrar(hash, clave));
+        ok &= !hash_abierto_pertenece(hash, clave);
+    }
+    print_test("Prueba hash abierto borrar la mitad", ok && hash_abierto_cantidad(hash) == largo / 2);
+    ok = true;
+    for (size_t i = 1; i < largo; i += 2) {
+        sprintf(clave, "%08zu", i);
+        ok &= hash_abierto_pertenece(hash, clave);
+    }
+    print_test("Prueba hash abierto las no borradas siguen", ok);
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "n%07zu", i);
+        hash_abierto_guardar(hash, clave, malloc(1));
+    }
+    size_t visitadas = 0;
+    hash_abierto_iterar(hash, contar_visitados, &visitadas);
+    print_test("Prueba hash abierto iterar recorre todas las claves", visitadas == largo);
+    print_test("Prueba hash abierto borrar clave inexistente es NULL", !hash_abierto_borrar(hash, "no esta"));
+
+    hash_abierto_destruir(hash);
+}
+
+/* Guarda la clave visitada en el arreglo de extra, en orden de recorrido */
+static bool anotar_clave(const char *clave, void *dato, void *extra)
+{
+    (void)dato;
+    char (**claves)[16] = extra;
+    strncpy(**claves, clave, 15);
+    (**claves)[15] = '\0';
+    (*claves)++;
+    return true;
+}
+
+static void prueba_hash_compacto_libres(void)
+{
+    hash_compacto_t* hash = hash_compacto_crear(NULL);
+    char clave[32];
+    for (size_t i = 0; i < 100; i++) {
+        sprintf(clave, "%08zu", i);
+        hash_compacto_guardar(hash, clave, NULL);
+    }
+    size_t memoria = hash_compacto_memoria(hash);
+
+    /* hash_compacto_iterar recorre el arreglo de entradas, así que muestra
+     * dónde quedó cada clave: la última entrada borrada es la primera en
+     * reusarse */
+    hash_compacto_borrar(hash, "00000010");
+    hash_compacto_borrar(hash, "00000020");
+    hash_compacto_borrar(hash, "00000030");
+    hash_compacto_guardar(hash, "a", NULL);
+    hash_compacto_guardar(hash, "b", NULL);
+    hash_compacto_guardar(hash, "c", NULL);
+    char orden[100][16];
+    char (*siguiente)[16] = orden;
+    hash_compacto_iterar(hash, anotar_clave, &siguiente);
+    print_test("Prueba hash compacto iterar ve las 100 entradas", siguiente == orden + 100);
+    print_test("Prueba hash compacto reusa las entradas borradas, la ultima primero",
+               !strcmp(orden[30], "a") && !strcmp(orden[20], "b") && !strcmp(orden[10], "c"));
+    print_test("Prueba hash compacto las demas no se movieron", !strcmp(orden[9], "00000009") && !strcmp(orden[99], "00000099"));
+    print_test("Prueba hash compacto reusar entradas no pide memoria", hash_compacto_memoria(hash) == memoria);
+
+    /* Una entrada libre se reusa también con una clave que ya estuvo */
+    hash_compacto_borrar(hash, "a");
+    print_test("Prueba hash compacto volver a guardar una borrada", hash_compacto_guardar(hash, "00000010", NULL) && hash_compacto_cantidad(hash) == 100);
+    siguiente = orden;
+    hash_compacto_iterar(hash, anotar_clave, &siguiente);
+    print_test("Prueba hash compacto la borrada vuelve a la entrada libre", !strcmp(orden[30], "00000010"));
+
+    hash_compacto_destruir(hash);
+}
+
+static void prueba_hash_compacto_claves(size_t largo)
+{
+    hash_compacto_t* hash = hash_compacto_crear(free);
+    char clave[32];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "a%07zu", i);
+        size_t* dato = malloc(sizeof(size_t));
+        *dato = i;
+        ok &= hash_compacto_guardar(hash, clave, dato);
+    }
+    print_test("Prueba hash compacto guardar muchas claves", ok && hash_compacto_cantidad(hash) == largo);
+    size_t memoria = hash_compacto_memoria(hash);
+
+    /* Cada vuelta borra nueve de cada diez claves y guarda otras tantas
+     * nuevas del mismo largo: sin compactar, el bloque de claves crecería
+     * en cada vuelta, y al compactar las claves que quedan cambian de lugar */
+    for (char vuelta = 'b'; vuelta <= 'z'; vuelta++) {
+        for (size_t i = 0; i < largo; i++) {
+            if (i % 10 == 9) continue;
+            sprintf(clave, "%c%07zu", vuelta - 1, i);
+            free(hash_compacto_borrar(hash, clave));
+            ok &= !hash_compacto_pertenece(hash, clave);
+        }
+        for (size_t i = 0; i < largo; i++) {
+            if (i % 10 == 9) continue;
+            sprintf(clave, "%c%07zu", vuelta, i);
+            size_t* dato = malloc(sizeof(size_t));
+            *dato = i;
+            ok &= hash_compacto_guardar(hash, clave, dato);
+        }
+    }
+    print_test("Prueba hash compacto borrar y guardar muchas vueltas", ok && hash_compacto_cantidad(hash) == largo);
+    print_test("Prueba hash compacto compactar no agranda las claves", hash_compacto_memoria(hash) == memoria);
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%c%07zu", i % 10 == 9 ? 'a' : 'z', i);
+        size_t* dato = hash_compacto_obtener(hash, clave);
+        ok &= dato && *dato == i;
+    }
+    print_test("Prueba hash compacto las claves movidas siguen", ok);
+    print_test("Prueba hash compacto prefijo de una clave", !hash_compacto_pertenece(hash, "a000000"));
+
+    /* Una clave más larga que todo el bloque lo agranda de una vez */
+    size_t largo_clave = memoria * 4;
+    char* larga = malloc(largo_clave + 1);
+    memset(larga, 'x', largo_clave);
+    larga[largo_clave] = '\0';
+    ok = hash_compacto_guardar(hash, larga, malloc(1));
+    larga[largo_clave - 1] = 'y';
+    ok &= !hash_compacto_pertenece(hash, larga);
+    larga[largo_clave - 1] = 'x';
+    print_test("Prueba hash compacto guardar una clave mas larga que el bloque", ok && hash_compacto_pertenece(hash, larga));
+    free(hash_compacto_borrar(hash, larga));
+    free(larga);
+
+    hash_compacto_destruir(hash);
+}
+
+static void prueba_hash_compacto_tamanio(size_t largo)
+{
+    hash_compacto_t* hash = hash_compacto_crear(NULL);
+    hash_t* comun = hash_crear(NULL);
+    char clave[32];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        hash_compacto_guardar(hash, clave, NULL);
+        hash_guardar(comun, clave, NULL);
+    }
+    /* Cada clave ocupa su dato, tres enteros de 32 bits y un enlace en su
+     * entrada, una cabeza de cadena de 32 bits y sus 9 bytes; los arreglos
+     * crecen al doble, así que a lo sumo se tiene pedido el doble */
+    size_t por_clave = sizeof(void*) + 5 * sizeof(uint32_t) + 9;
+    print_test("Prueba hash compacto ocupa a lo sumo el doble de lo justo", hash_compacto_memoria(hash) <= 2 * largo * por_clave + 1024);
+    print_test("Prueba hash compacto ocupa menos de dos tercios de hash_t", hash_compacto_memoria(hash) * 3 < hash_memoria(comun) * 2);
+    hash_destruir(comun);
+    hash_compacto_destruir(hash);
+}
+
+#define HILOS_INTERNADOR 4
+
+typedef struct prueba_internador {
+    hash_internador_t* internador;
+    size_t largo;
+    size_t desde;
+    bool ok;
+} prueba_internador_t;
+
+static void *internar_todas(void *extra)
+{
+    prueba_internador_t* prueba = extra;
+    char cadena[32];
+    for (size_t k = 0; k < prueba->largo; k++) {
+        size_t i = (prueba->desde + k) % prueba->largo;
+        sprintf(cadena, "%zu", i);
+        uint32_t id;
+        const char* internada = hash_internar(prueba->internador, cadena, &id);
+        prueba->ok &= internada && !strcmp(internada, cadena) && hash_internador_cadena(prueba->internador, id) == internada;
+    }
+    return NULL;
+}
+
+static void prueba_hash_internador(size_t largo)
+{
+    hash_internador_t* internador = hash_internador_crear();
+    uint32_t id_a, id_b, id;
+    const char* a = hash_internar(internador, "a", &id_a);
+    const char* b = hash_internar(internador, "b", &id_b);
+    char otra_a[] = "a";
+    print_test("Prueba internador ids consecutivos", id_a == 0 && id_b == 1 && hash_internador_cantidad(internador) == 2);
+    print_test("Prueba internador misma cadena mismo puntero e id", hash_internar(internador, otra_a, &id) == a && id == id_a && a != otra_a);
+    print_test("Prueba internador cadena por id", hash_internador_cadena(internador, id_b) == b && !hash_internador_cadena(internador, 2));
+    print_test("Prueba internador buscar no interna", !hash_internador_buscar(internador, "c", NULL) && hash_internador_cantidad(internador) == 2);
+
+    /* Varios hilos internan las mismas cadenas en distinto orden */
+    pthread_t hilos[HILOS_INTERNADOR];
+    prueba_internador_t pruebas[HILOS_INTERNADOR];
+    for (size_t k = 0; k < HILOS_INTERNADOR; k++) {
+        pruebas[k] = (prueba_internador_t){internador, largo, k * largo / HILOS_INTERNADOR, true};
+        pthread_create(&hilos[k], NULL, internar_todas, &pruebas[k]);
+    }
+    bool ok = true;
+    for (size_t k = 0; k < HILOS_INTERNADOR; k++) {
+        pthread_join(hilos[k], NULL);
+        ok &= pruebas[k].ok;
+    }
+    print_test("Prueba internador desde varios hilos", ok && hash_internador_cantidad(internador) == largo + 2);
+    ok = true;
+    for (uint32_t i = 2; i < largo + 2; i++) {
+        const char* cadena = hash_internador_cadena(internador, i);
+        ok &= cadena && hash_internador_buscar(internador, cadena, &id) == cadena && id == i;
+    }
+    print_test("Prueba internador ids densos y estables", ok);
+
+    /* Dos hashes con el mismo internador guardan la misma copia de cada clave */
+    hash_t* hash1 = hash_crear(NULL);
+    hash_t* hash2 = hash_crear(NULL);
+    hash_t* comun = hash_crear(NULL);
+    print_test("Prueba hash usar internador", hash_usar_internador(hash1, internador) && hash_usar_internador(hash2, internador));
+    char clave[32];
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_guardar(hash1, clave, NULL) && hash_guardar(hash2, clave, NULL) && hash_guardar(comun, clave, NULL);
+        ok &= hash_obtener_clave(hash1, clave) == hash_internador_buscar(internador, clave, NULL);
+        ok &= hash_obtener_clave(hash1, clave) == hash_obtener_clave(hash2, clave);
+    }
+    print_test("Prueba hash con internador comparte las claves", ok && hash_internador_cantidad(internador) == largo + 2);
+    print_test("Prueba hash con internador busca por la cadena internada", hash_pertenece(hash1, hash_internar(internador, "7", NULL)));
+    print_test("Prueba hash no vacío no cambia de internador", !hash_usar_internador(comun, internador));
+    print_test("Prueba hash con internador no congela", !hash_congelar_claves(hash1));
+    hash_borrar(hash1, "7");
+    print_test("Prueba hash con internador borrar no libera la cadena", !hash_pertenece(hash1, "7") && hash_pertenece(hash2, "7") && hash_internador_buscar(internador, "7", NULL));
+
+    /* Fusionar entre hashes con y sin internador copia las claves */
+    print_test("Prueba hash fusionar hacia hash con internador", hash_fusionar(hash1, comun, HASH_CONSERVAR_DESTINO) && hash_cantidad(hash1) == largo);
+    print_test("Prueba hash fusionar guarda la clave internada", hash_obtener_clave(hash1, "7") == hash_internador_buscar(internador, "7", NULL));
+    print_test("Prueba hash fusionar desde hash con internador", hash_fusionar(comun, hash2, HASH_CONSERVAR_DESTINO) && hash_cantidad(comun) == largo);
+    print_test("Prueba hash fusionar copia la clave internada", hash_obtener_clave(comun, "7") != hash_internador_buscar(internador, "7", NULL));
+    hash_destruir(hash1);
+    hash_destruir(hash2);
+    hash_destruir(comun);
+    hash_internador_destruir(internador);
+}
+
+#define HILOS_COLA 4
+
+typedef struct prueba_cola {
+    cola_concurrente_t* cola;
+    size_t largo;
+    size_t suma;
+} prueba_cola_t;
+
+static void *producir(void *extra)
+{
+    prueba_cola_t* prueba = extra;
+    for (size_t i = 1; i <= prueba->largo; i++) {
+        while (!cola_concurrente_encolar(prueba->cola, (void*)i)) sched_yield();
+    }
+    return NULL;
+}
+
+static void *consumir(void *extra)
+{
+    prueba_cola_t* prueba = extra;
+    void* dato;
+    for (size_t i = 0; i < prueba->largo; i++) {
+        while (!cola_concurrente_desencolar(prueba->cola, &dato)) sched_yield();
+        prueba->suma += (size_t)dato;
+    }
+    return NULL;
+}
+
+static void prueba_cola_concurrente(size_t largo)
+{
+    cola_concurrente_t* cola = cola_concurrente_crear(100);
+    print_test("Prueba cola concurrente crear redondea la capacidad", cola_concurrente_capacidad(cola) == 128);
+    print_test("Prueba cola concurrente crear con capacidad enorme es NULL", !cola_concurrente_crear(SIZE_MAX));
+    print_test("Prueba cola concurrente crear con capacidad que desborda es NULL", !cola_concurrente_crear(SIZE_MAX / 2 + 2));
+    void* dato;
+    print_test("Prueba cola concurrente vacia no desencola", !cola_concurrente_desencolar(cola, &dato));
+    bool ok = true;
+    for (size_t i = 0; i < 128; i++) ok &= cola_concurrente_encolar(cola, (void*)i);
+    print_test("Prueba cola concurrente encolar hasta llenarla", ok && !cola_concurrente_encolar(cola, NULL));
+    print_test("Prueba cola concurrente cantidad", cola_concurrente_cantidad(cola) == 128);
+    ok = true;
+    for (size_t i = 0; i < 128; i++) ok &= cola_concurrente_desencolar(cola, &dato) && (size_t)dato == i;
+    print_test("Prueba cola concurrente desencola en orden", ok && !cola_concurrente_desencolar(cola, &dato));
+
+    /* Varios productores y consumidores: cada valor se desencola una vez */
+    pthread_t hilos[2 * HILOS_COLA];
+    prueba_cola_t pruebas[HILOS_COLA];
+    for (size_t i = 0; i < HILOS_COLA; i++) {
+        pruebas[i] = (prueba_cola_t){cola, largo, 0};
+        pthread_create(&hilos[i], NULL, producir, &pruebas[i]);
+        pthread_create(&hilos[HILOS_COLA + i], NULL, consumir, &pruebas[i]);
+    }
+    size_t suma = 0;
+    for (size_t i = 0; i < 2 * HILOS_COLA; i++) pthread_join(hilos[i], NULL);
+    for (size_t i = 0; i < HILOS_COLA; i++) suma += pruebas[i].suma;
+    print_test("Prueba cola concurrente con varios hilos", suma == HILOS_COLA * largo * (largo + 1) / 2);
+    print_test("Prueba cola concurrente queda vacia", cola_concurrente_cantidad(cola) == 0);
+
+    cola_concurrente_encolar(cola, malloc(1));
+    cola_concurrente_destruir(cola, free);
+}
+
+static atomic_size_t destruidos;
+
+static void contar_destruido(void *dato)
+{
+    (void)dato;
+    atomic_fetch_add(&destruidos, 1);
+}
+
+static void prueba_hash_destruir_por_partes(size_t largo)
+{
+    hash_t* hash = hash_crear(contar_destruido);
+    char clave[32];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        if (i % 3) hash_guardar(hash, clave, NULL);
+        else hash_guardar_con_ttl(hash, clave, NULL, 0, i);
+    }
+    hash_congelar_claves(hash);
+    hash_indice_activar(hash);
+
+    /* Los nodos del índice se liberan antes que los elementos, también
+     * dentro del presupuesto */
+    atomic_store(&destruidos, 0);
+    size_t llamadas = 0;
+    bool ok = true;
+    while (atomic_load(&destruidos) == 0) {
+        ok &= !hash_destruir_por_partes(hash, 1);
+        llamadas++;
+    }
+    print_test("Prueba hash destruir por partes libera el indice de a un nodo", ok && llamadas > largo / 100);
+
+    llamadas = 1;
+    while (!hash_destruir_por_partes(hash, 100)) {
+        ok &= atomic_load(&destruidos) <= llamadas * 100;
+        llamadas++;
+    }
+    print_test("Prueba hash destruir por partes respeta el presupuesto", ok && llamadas > largo / 100);
+    print_test("Prueba hash destruir por partes destruye todos los datos", atomic_load(&destruidos) == largo);
+
+    hash = hash_crear(contar_destruido);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, NULL);
+    }
+    atomic_store(&destruidos, 0);
+    hash_destruir_diferido(hash);
+    for (size_t i = 0; i < 100000 && atomic_load(&destruidos) < largo; i++) sched_yield();
+    print_test("Prueba hash destruir diferido destruye todos los datos", atomic_load(&destruidos) == largo);
+}
+
+static void prueba_hash_memoria(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+    char clave[32];
+    size_t vacio = hash_memoria(hash);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_guardar(hash, clave, NULL);
+    }
+    print_test("Prueba hash memoria crece con las claves", ok && hash_memoria(hash) > vacio + largo * strlen("0000"));
+
+    hash_limitar_memoria(hash, hash_memoria(hash));
+    print_test("Prueba hash memoria no guarda claves nuevas sobre el límite", !hash_guardar(hash, "no entra", NULL));
+    print_test("Prueba hash memoria la clave rechazada no está", !hash_pertenece(hash, "no entra") && hash_cantidad(hash) == largo);
+    print_test("Prueba hash memoria reemplazar sobre el límite", hash_guardar(hash, "0", &ok) && hash_obtener(hash, "0") == &ok);
+    print_test("Prueba hash memoria el filtro respeta el límite", !hash_filtro_activar(hash, 8));
+    hash_borrar(hash, "1");
+    print_test("Prueba hash memoria borrar libera lugar", hash_guardar(hash, "x", NULL));
+    hash_destruir(hash);
+
+    // Con límite el hash deja de crecer pero sigue guardando mientras entra
+    hash = hash_crear(NULL);
+    size_t limite = vacio + largo * 50;
+    hash_limitar_memoria(hash, limite);
+    size_t guardadas = 0;
+    ok = true;
+    for (size_t i = 0; i < largo * 2; i++) {
+        sprintf(clave, "%zu", i);
+        if (!hash_guardar(hash, clave, NULL)) break;
+        guardadas++;
+        ok &= hash_memoria(hash) <= limite;
+    }
+    print_test("Prueba hash memoria nunca pasa el límite", ok && guardadas > 0 && guardadas < largo * 2);
+    ok = true;
+    for (size_t i = 0; i < guardadas; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_pertenece(hash, clave);
+    }
+    print_test("Prueba hash memoria las claves guardadas están", ok && hash_cantidad(hash) == guardadas);
+    hash_destruir(hash);
+
+    void* arreglo = memoria_reservar((size_t)4 << 20, true);
+    ok = arreglo && (uintptr_t)arreglo % ((size_t)2 << 20) == 0;
+    for (size_t i = 0; ok && i < ((size_t)4 << 20); i += 4096) ok &= ((char*)arreglo)[i] == 0;
+    print_test("Prueba memoria reservar con páginas grandes alinea y limpia", ok);
+    memoria_liberar(arreglo, (size_t)4 << 20);
+
+    // Suficientes claves para que los arreglos ocupen más de una página grande
+    hash = hash_crear(NULL);
+    hash_abierto_t* abierto = hash_abierto_crear(NULL);
+    hash_usar_paginas_grandes(hash, true);
+    hash_abierto_usar_paginas_grandes(abierto, true);
+    ok = true;
+    for (size_t i = 0; i < largo * 100; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_guardar(hash, clave, NULL) && hash_abierto_guardar(abierto, clave, NULL);
+    }
+    for (size_t i = 0; i < largo * 100; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_pertenece(hash, clave) && hash_abierto_pertenece(abierto, clave);
+    }
+    print_test("Prueba hash con páginas grandes guarda y encuentra las claves", ok);
+    hash_destruir(hash);
+    hash_abierto_destruir(abierto);
+}
+
 static void prueba_hash_volumen(size_t largo, bool debug)
 {
     hash_t* hash = hash_crear(NULL);
@@ -392,6 +1620,107 @@ static void prueba_hash_iterar_volumen(size_t largo)
     hash_destruir(hash);
 }
 
+static void prueba_hash_iterar_borrando(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+
+    size_t valores[largo];
+
+    bool ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08d", i);
+        valores[i] = i;
+        ok &= hash_guardar(hash, claves[i], &valores[i]);
+    }
+    print_test("Prueba hash iterar borrando, se insertaron los elementos", ok);
+
+    /* Borra los elementos pares en una sola pasada */
+    hash_iter_t* iter = hash_iter_crear(hash);
+    size_t recorridos = 0, borrados = 0;
+    ok = true;
+    while (!hash_iter_al_final(iter)) {
+        size_t *valor = hash_obtener(hash, hash_iter_ver_actual(iter));
+        recorridos++;
+        if (*valor % 2 == 0) {
+            ok &= hash_iter_borrar_actual(iter) == valor;
+            borrados++;
+        } else {
+            hash_iter_avanzar(iter);
+        }
+    }
+    print_test("Prueba hash iterar borrando, se recorrieron todos", recorridos == largo);
+    print_test("Prueba hash iterar borrando, se devolvieron los datos", ok);
+    print_test("Prueba hash iterar borrando, el iterador no fue invalidado", !hash_iter_invalidado(iter));
+    print_test("Prueba hash iterar borrando, la cantidad es la esperada", hash_cantidad(hash) == largo - borrados);
+
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_pertenece(hash, claves[i]) == (i % 2 != 0);
+    }
+    print_test("Prueba hash iterar borrando, quedan sólo los impares", ok);
+    hash_iter_destruir(iter);
+
+    /* Modificar el hash por fuera del iterador lo invalida */
+    iter = hash_iter_crear(hash);
+    print_test("Prueba hash iterador no invalidado", !hash_iter_invalidado(iter));
+    print_test("Prueba hash guardar clave nueva", hash_guardar(hash, "nueva", NULL));
+    print_test("Prueba hash iterador invalidado", hash_iter_invalidado(iter));
+    print_test("Prueba hash iterador invalidado esta al final", hash_iter_al_final(iter));
+    print_test("Prueba hash iterador invalidado ver actual es NULL", !hash_iter_ver_actual(iter));
+    print_test("Prueba hash iterador invalidado avanzar es false", !hash_iter_avanzar(iter));
+
+    free(claves);
+    hash_iter_destruir(iter);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_reemplazar_al_agrandar()
+{
+    hash_t* hash = hash_crear(NULL);
+    char clave[8];
+
+    /* Con 34 claves en 17 listas, la próxima inserción agranda el hash */
+    bool ok = true;
+    for (size_t i = 0; i < 34; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_guardar(hash, clave, NULL);
+    }
+    print_test("Prueba hash reemplazar al agrandar, guardar 34 claves", ok);
+
+    /* Reemplazar no agranda, así que no invalida el iterador */
+    hash_iter_t* iter = hash_iter_crear(hash);
+    print_test("Prueba hash reemplazar al agrandar, reemplazar una clave", hash_guardar(hash, "0", hash));
+    print_test("Prueba hash reemplazar al agrandar, iterador no invalidado", !hash_iter_invalidado(iter));
+    print_test("Prueba hash reemplazar al agrandar, obtener el dato nuevo", hash_obtener(hash, "0") == hash);
+
+    size_t recorridos = 0;
+    while (!hash_iter_al_final(iter)) {
+        recorridos++;
+        hash_iter_avanzar(iter);
+    }
+    print_test("Prueba hash reemplazar al agrandar, se recorrieron todas", recorridos == 34);
+
+    /* Insertar una clave nueva sí lo invalida */
+    hash_iter_destruir(iter);
+    iter = hash_iter_crear(hash);
+    print_test("Prueba hash reemplazar al agrandar, guardar clave nueva", hash_guardar(hash, "34", NULL));
+    print_test("Prueba hash reemplazar al agrandar, iterador invalidado", hash_iter_invalidado(iter));
+    print_test("Prueba hash reemplazar al agrandar, la cantidad es 35", hash_cantidad(hash) == 35);
+
+    ok = true;
+    for (size_t i = 0; i < 35; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_pertenece(hash, clave);
+    }
+    print_test("Prueba hash reemplazar al agrandar, pertenecen todas", ok);
+
+    hash_iter_destruir(iter);
+    hash_destruir(hash);
+}
+
 /* ******************************************************************
  *                        FUNCIÓN PRINCIPAL
  * *****************************************************************/
@@ -405,12 +1734,38 @@ void pruebas_hash_catedra()
     prueba_hash_insertar();
     prueba_hash_reemplazar();
     prueba_hash_reemplazar_con_destruir();
+    prueba_hash_reemplazar_al_agrandar();
     prueba_hash_borrar();
     prueba_hash_clave_vacia();
     prueba_hash_valor_null();
+    prueba_hash_obtener_o_insertar();
+    prueba_hash_actualizar();
+    prueba_hash_con_hash();
+    prueba_hash_cache();
+    prueba_hash_vencimientos();
+    prueba_hash_instantanea(5000);
+    prueba_hash_instantanea_vencimientos();
+    prueba_hash_registro();
+    prueba_hash_congelar_claves(5000);
+    prueba_hash_filtro(5000);
+    prueba_hash_indice(5000);
+    prueba_hash_iter_ver_dato(5000);
+    prueba_hash_multi(5000);
+    prueba_hash_conjunto(5000);
+    prueba_hash_fusionar(5000);
+    prueba_hash_diferencia(5000);
+    prueba_hash_abierto(5000);
+    prueba_hash_compacto_libres();
+    prueba_hash_compacto_claves(5000);
+    prueba_hash_compacto_tamanio(5000);
+    prueba_hash_internador(5000);
+    prueba_cola_concurrente(100000);
+    prueba_hash_destruir_por_partes(5000);
+    prueba_hash_memoria(5000);
     prueba_hash_volumen(5000, true);
     prueba_hash_iterar();
     prueba_hash_iterar_volumen(5000);
+    prueba_hash_iterar_borrando(5000);
 }
 
 void pruebas_volumen_catedra(size_t largo)
@@ -0,0 +1,338 @@
+#define _POSIX_C_SOURCE 200809L
+#include "hash_registro.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#define TAM_BUFFER 65536
+#define TAM_ENCABEZADO 9
+#define TAM_CRC 4
+#define GUARDAR 'G'
+#define BORRAR 'B'
+#define SUFIJO_COMPACTANDO ".compactando"
+
+/* Cada entrada del registro es:
+ *   tipo (1 byte), largo de la clave y largo del dato (4 bytes cada uno,
+ *   little endian), la clave sin el '\0', el dato, y el CRC-32 de todo lo
+ *   anterior (4 bytes).
+ * Las entradas se arman en buffer y se escriben al archivo al llenarlo o al
+ * sincronizar. tam_archivo incluye lo que está en el buffer. */
+struct hash_registro{
+    hash_t* hash;
+    char* ruta;
+    int fd;
+    unsigned char* buffer;
+    size_t usado;
+    size_t capacidad;
+    size_t tam_archivo;
+    size_t sin_sincronizar;
+    size_t sincronizar_cada;
+};
+
+/* Dato guardado en el hash */
+typedef struct valor{
+    size_t tam;
+    unsigned char bytes[];
+} valor_t;
+
+uint32_t crc32_actualizar(uint32_t crc, const unsigned char* bytes, size_t n){
+    static uint32_t tabla[256];
+    if (!tabla[1]){
+        for (uint32_t i = 0; i < 256; i++){
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            tabla[i] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = tabla[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void escribir_u32(unsigned char* destino, uint32_t n){
+    for (int i = 0; i < 4; i++) destino[i] = (unsigned char)(n >> (8 * i));
+}
+
+uint32_t leer_u32(const unsigned char* origen){
+    uint32_t n = 0;
+    for (int i = 0; i < 4; i++) n |= (uint32_t)origen[i] << (8 * i);
+    return n;
+}
+
+/* Escribe los n bytes, y devuelve en escritos cuántos llegó a escribir
+ * aunque falle */
+bool escribir_todo(int fd, const unsigned char* bytes, size_t n, size_t* escritos){
+    *escritos = 0;
+    while (*escritos < n){
+        ssize_t escritos_ahora = write(fd, bytes + *escritos, n - *escritos);
+        if (escritos_ahora < 0 && errno == EINTR) continue;
+        if (escritos_ahora < 0) return false;
+        *escritos += (size_t)escritos_ahora;
+    }
+    return true;
+}
+
+/* Escribe el buffer en el archivo, sin sincronizarlo. Si falla a mitad de
+ * camino, quita del buffer lo que llegó a escribirse, para que el próximo
+ * intento siga desde ahí sin repetir entradas. */
+bool vaciar_buffer(hash_registro_t* reg){
+    size_t escritos;
+    bool ok = escribir_todo(reg->fd, reg->buffer, reg->usado, &escritos);
+    reg->usado -= escritos;
+    if (reg->usado) memmove(reg->buffer, reg->buffer + escritos, reg->usado);
+    return ok;
+}
+
+/* Se asegura de que entren n bytes más en el buffer, vaciándolo o
+ * agrandándolo si hace falta */
+bool reservar(hash_registro_t* reg, size_t n){
+    if (reg->usado + n <= reg->capacidad) return true;
+    if (!vaciar_buffer(reg)) return false;
+    if (n <= reg->capacidad) return true;
+    unsigned char* buffer = realloc(reg->buffer, n);
+    if (!buffer) return false;
+    reg->buffer = buffer;
+    reg->capacidad = n;
+    return true;
+}
+
+size_t tam_entrada(size_t largo_clave, size_t tam){
+    return TAM_ENCABEZADO + largo_clave + tam + TAM_CRC;
+}
+
+/* Arma la entrada en el buffer, donde ya se reservó su lugar */
+void codificar_entrada(hash_registro_t* reg, char tipo, const char* clave, size_t largo_clave, const void* dato, size_t tam){
+    unsigned char* entrada = reg->buffer + reg->usado;
+    entrada[0] = (unsigned char)tipo;
+    escribir_u32(entrada + 1, (uint32_t)largo_clave);
+    escribir_u32(entrada + 5, (uint32_t)tam);
+    memcpy(entrada + TAM_ENCABEZADO, clave, largo_clave);
+    if (tam) memcpy(entrada + TAM_ENCABEZADO + largo_clave, dato, tam);
+    size_t n = TAM_ENCABEZADO + largo_clave + tam;
+    escribir_u32(entrada + n, crc32_actualizar(0, entrada, n));
+    reg->usado += n + TAM_CRC;
+    reg->tam_archivo += n + TAM_CRC;
+}
+
+/* Quita del buffer la última entrada, de n bytes, que no llegó a vaciarse */
+void descartar_entrada(hash_registro_t* reg, size_t n){
+    reg->usado -= n;
+    reg->tam_archivo -= n;
+}
+
+valor_t* crear_valor(const void* dato, size_t tam){
+    valor_t* valor = malloc(sizeof(valor_t) + tam);
+    if (!valor) return NULL;
+    valor->tam = tam;
+    if (tam) memcpy(valor->bytes, dato, tam);
+    return valor;
+}
+
+/* Aplica al hash las entradas del archivo, y devuelve en valido dónde
+ * termina la última entrada completa. Devuelve false si falló la lectura o
+ * no hubo memoria. */
+bool reproducir(hash_registro_t* reg, FILE* archivo, size_t tam, size_t* valido){
+    unsigned char encabezado[TAM_ENCABEZADO];
+    unsigned char* entrada = NULL;
+    size_t pos = 0;
+    bool ok = true;
+
+    while (fread(encabezado, 1, TAM_ENCABEZADO, archivo) == TAM_ENCABEZADO){
+        size_t largo_clave = leer_u32(encabezado + 1);
+        size_t largo_dato = leer_u32(encabezado + 5);
+        size_t n = tam_entrada(largo_clave, largo_dato);
+        if ((encabezado[0] != GUARDAR && encabezado[0] != BORRAR) || n > tam - pos) break;
+
+        unsigned char* nueva = realloc(entrada, n + 1);
+        if (!nueva){
+            ok = false;
+            break;
+        }
+        entrada = nueva;
+        memcpy(entrada, encabezado, TAM_ENCABEZADO);
+        if (fread(entrada + TAM_ENCABEZADO, 1, n - TAM_ENCABEZADO, archivo) != n - TAM_ENCABEZADO) break;
+        if (crc32_actualizar(0, entrada, n - TAM_CRC) != leer_u32(entrada + n - TAM_CRC)) break;
+
+        // Corre el dato un byte para terminar la clave con '\0'; el último
+        // byte pisa el CRC, que ya se verificó
+        unsigned char* dato = entrada + TAM_ENCABEZADO + largo_clave;
+        valor_t* valor = encabezado[0] == GUARDAR ? crear_valor(dato, largo_dato) : NULL;
+        memmove(dato + 1, dato, largo_dato);
+        *dato = '\0';
+        const char* clave = (const char*)entrada + TAM_ENCABEZADO;
+        if (encabezado[0] == BORRAR){
+            free(hash_borrar(reg->hash, clave));
+        }
+        else if (!valor || !hash_guardar(reg->hash, clave, valor)){
+            free(valor);
+            ok = false;
+            break;
+        }
+        pos += n;
+    }
+    if (ferror(archivo)) ok = false;
+    free(entrada);
+    *valido = pos;
+    return ok;
+}
+
+hash_registro_t *hash_registro_abrir(const char *ruta, size_t sincronizar_cada){
+    hash_registro_t* reg = malloc(sizeof(hash_registro_t));
+    if (!reg) return NULL;
+    reg->hash = hash_crear(free);
+    reg->ruta = malloc(strlen(ruta) + 1);
+    reg->buffer = malloc(TAM_BUFFER);
+    reg->fd = open(ruta, O_WRONLY | O_CREAT, 0644);
+    FILE* archivo = reg->fd < 0 ? NULL : fopen(ruta, "rb");
+    struct stat estado;
+    size_t valido = 0;
+    if (!reg->hash || !reg->ruta || !reg->buffer || !archivo || fstat(reg->fd, &estado)
+        || !reproducir(reg, archivo, (size_t)estado.st_size, &valido)
+        || ftruncate(reg->fd, (off_t)valido) || lseek(reg->fd, 0, SEEK_END) < 0){
+        if (archivo) fclose(archivo);
+        if (reg->fd >= 0) close(reg->fd);
+        if (reg->hash) hash_destruir(reg->hash);
+        free(reg->ruta); free(reg->buffer); free(reg);
+        return NULL;
+    }
+    fclose(archivo);
+
+    strcpy(reg->ruta, ruta);
+    reg->usado = 0;
+    reg->capacidad = TAM_BUFFER;
+    reg->tam_archivo = valido;
+    reg->sin_sincronizar = 0;
+    reg->sincronizar_cada = sincronizar_cada;
+    return reg;
+}
+
+/* Cuenta una modificación registrada, sincronizando si corresponde */
+bool terminar_modificacion(hash_registro_t* reg){
+    reg->sin_sincronizar++;
+    if (reg->sincronizar_cada && reg->sin_sincronizar >= reg->sincronizar_cada){
+        return hash_registro_sincronizar(reg);
+    }
+    return true;
+}
+
+bool hash_registro_guardar(hash_registro_t *reg, const char *clave, const void *dato, size_t tam){
+    size_t largo_clave = strlen(clave);
+    size_t n = tam_entrada(largo_clave, tam);
+    if (!reservar(reg, n)) return false;
+    // Se registra antes de modificar el hash, y se descarta si no se pudo
+    codificar_entrada(reg, GUARDAR, clave, largo_clave, dato, tam);
+    valor_t* valor = crear_valor(dato, tam);
+    if (!valor || !hash_guardar(reg->hash, clave, valor)){
+        free(valor);
+        descartar_entrada(reg, n);
+        return false;
+    }
+    return terminar_modificacion(reg);
+}
+
+bool hash_registro_borrar(hash_registro_t *reg, const char *clave){
+    size_t largo_clave = strlen(clave);
+    if (!hash_pertenece(reg->hash, clave) || !reservar(reg, tam_entrada(largo_clave, 0))) return false;
+    codificar_entrada(reg, BORRAR, clave, largo_clave, NULL, 0);
+    free(hash_borrar(reg->hash, clave));
+    return terminar_modificacion(reg);
+}
+
+const void *hash_registro_obtener(const hash_registro_t *reg, const char *clave, size_t *tam){
+    valor_t* valor = hash_obtener(reg->hash, clave);
+    if (!valor) return NULL;
+    *tam = valor->tam;
+    return valor->bytes;
+}
+
+size_t hash_registro_cantidad(const hash_registro_t *reg){
+    return hash_cantidad(reg->hash);
+}
+
+size_t hash_registro_tam(const hash_registro_t *reg){
+    return reg->tam_archivo;
+}
+
+bool hash_registro_sincronizar(hash_registro_t *reg){
+    if (!vaciar_buffer(reg) || fsync(reg->fd)) return false;
+    reg->sin_sincronizar = 0;
+    return true;
+}
+
+/* Sincroniza el directorio de la ruta, para que un rename sea durable */
+bool sincronizar_directorio(const char* ruta){
+    const char* barra = strrchr(ruta, '/');
+    char* directorio = barra ? strndup(ruta, (size_t)(barra - ruta) + 1) : strdup(".");
+    if (!directorio) return false;
+    int fd = open(directorio, O_RDONLY);
+    free(directorio);
+    if (fd < 0) return false;
+    bool ok = !fsync(fd);
+    close(fd);
+    return ok;
+}
+
+/* Escribe en el registro, que debe estar vacío, una entrada por clave */
+bool escribir_claves(hash_registro_t* reg){
+    hash_iter_t* iter = hash_iter_crear(reg->hash);
+    if (!iter) return false;
+    bool ok = true;
+    while (ok && !hash_iter_al_final(iter)){
+        const char* clave = hash_iter_ver_actual(iter);
+        valor_t* valor = hash_obtener(reg->hash, clave);
+        size_t largo_clave = strlen(clave);
+        ok = reservar(reg, tam_entrada(largo_clave, valor->tam));
+        if (ok) codificar_entrada(reg, GUARDAR, clave, largo_clave, valor->bytes, valor->tam);
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    return ok && vaciar_buffer(reg) && !fsync(reg->fd);
+}
+
+bool hash_registro_compactar(hash_registro_t *reg){
+    if (!vaciar_buffer(reg)) return false;
+    char* temporal = malloc(strlen(reg->ruta) + sizeof(SUFIJO_COMPACTANDO));
+    if (!temporal) return false;
+    strcpy(temporal, reg->ruta);
+    strcat(temporal, SUFIJO_COMPACTANDO);
+    int fd = open(temporal, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0){
+        free(temporal);
+        return false;
+    }
+
+    int fd_anterior = reg->fd;
+    size_t tam_anterior = reg->tam_archivo;
+    reg->fd = fd;
+    reg->tam_archivo = 0;
+    if (!escribir_claves(reg) || rename(temporal, reg->ruta)){
+        // Lo que quedó en el buffer es del archivo temporal
+        reg->usado = 0;
+        reg->fd = fd_anterior;
+        reg->tam_archivo = tam_anterior;
+        close(fd);
+        unlink(temporal);
+        free(temporal);
+        return false;
+    }
+    free(temporal);
+    close(fd_anterior);
+    reg->sin_sincronizar = 0;
+    return sincronizar_directorio(reg->ruta);
+}
+
+bool hash_registro_cerrar(hash_registro_t *reg){
+    bool ok = hash_registro_sincronizar(reg);
+    close(reg->fd);
+    hash_destruir(reg->hash);
+    free(reg->ruta);
+    free(reg->buffer);
+    free(reg);
+    return ok;
+}
@@ -0,0 +1,78 @@
+#ifndef HASH_REGISTRO_H
+#define HASH_REGISTRO_H
+
+#include "hash.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Hash persistente: cada modificación se agrega a un archivo de registro
+ * (write-ahead log) antes de volverse durable, y al abrirlo se reconstruye
+ * el hash releyendo el registro. Los datos son secuencias de bytes, que el
+ * hash guarda copiadas.
+ * Las escrituras al archivo se agrupan en memoria y se sincronizan con el
+ * disco (fsync) cada sincronizar_cada modificaciones: con 1 cada operación
+ * es durable al volver; con valores mayores se pierden a lo sumo las
+ * últimas modificaciones ante una caída; con 0 sólo se sincroniza al llamar
+ * a hash_registro_sincronizar, compactar o cerrar. */
+struct hash_registro;
+
+typedef struct hash_registro hash_registro_t;
+
+/* Abre el registro de la ruta, creándolo si no existe, y reconstruye el
+ * hash a partir de él. Un registro incompleto al final del archivo, como el
+ * que deja una caída durante una escritura, se descarta. Devuelve NULL si
+ * no se pudo abrir o leer el archivo.
+ */
+hash_registro_t *hash_registro_abrir(const char *ruta, size_t sincronizar_cada);
+
+/* Guarda una copia de los tam bytes de dato para la clave, reemplazando el
+ * dato anterior, y agrega la modificación al registro. Devuelve false si no
+ * se pudo guardar, en cuyo caso el hash no cambia; o si falló la
+ * sincronización, en cuyo caso el dato quedó guardado pero puede no ser
+ * durable.
+ * Pre: El registro fue abierto, tam entra en 32 bits
+ */
+bool hash_registro_guardar(hash_registro_t *reg, const char *clave, const void *dato, size_t tam);
+
+/* Borra la clave y agrega la modificación al registro. Devuelve false si la
+ * clave no estaba o no se pudo registrar el borrado, en cuyo caso el hash no
+ * cambia; o si falló la sincronización.
+ * Pre: El registro fue abierto
+ */
+bool hash_registro_borrar(hash_registro_t *reg, const char *clave);
+
+/* Devuelve los bytes guardados para la clave y guarda su cantidad en tam, o
+ * NULL si la clave no está. El puntero es válido hasta la próxima
+ * modificación de la clave.
+ * Pre: El registro fue abierto
+ */
+const void *hash_registro_obtener(const hash_registro_t *reg, const char *clave, size_t *tam);
+
+// Devuelve la cantidad de claves guardadas.
+size_t hash_registro_cantidad(const hash_registro_t *reg);
+
+// Devuelve el tamaño en bytes del archivo de registro, incluyendo lo que
+// todavía no se escribió.
+size_t hash_registro_tam(const hash_registro_t *reg);
+
+/* Escribe en el archivo las modificaciones agrupadas en memoria y lo
+ * sincroniza con el disco. Devuelve false si falló.
+ * Pre: El registro fue abierto
+ */
+bool hash_registro_sincronizar(hash_registro_t *reg);
+
+/* Reescribe el registro con una única entrada por clave, reemplazando el
+ * archivo de forma atómica: ante una caída queda el registro anterior o el
+ * compactado, nunca uno parcial. Devuelve false si falló, en cuyo caso el
+ * registro anterior sigue en uso.
+ * Pre: El registro fue abierto
+ */
+bool hash_registro_compactar(hash_registro_t *reg);
+
+/* Sincroniza el registro, cierra el archivo y destruye el hash. Devuelve
+ * false si falló la sincronización.
+ * Pre: El registro fue abierto
+ */
+bool hash_registro_cerrar(hash_registro_t *reg);
+
+#endif // HASH_REGISTRO_H
@@ -1,57 +1,138 @@
+#define _POSIX_C_SOURCE 200112L
 #include "lista.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 
+#define TAM_LINEA_CACHE 64
+
+/* Cada nodo guarda hasta "capacidad" datos consecutivos. Las listas comunes
+ * usan nodos de un solo dato; las desenrolladas, nodos del tamaño de una
+ * línea de caché. */
 typedef struct nodo {
-	void* dato;
 	struct nodo* prox;
+	unsigned cant;
+	unsigned capacidad;
+	void* datos[];
 } nodo_t;
 
+#define CAPACIDAD_DESENROLLADA ((TAM_LINEA_CACHE - sizeof(nodo_t)) / sizeof(void*))
+
+/* Los nodos liberados se guardan en "nodos", enlazados por prox, hasta un
+ * máximo de "maximo", para reutilizarlos en las próximas inserciones. */
+typedef struct libres {
+    nodo_t* nodos;
+    size_t cant;
+    size_t maximo;
+} libres_t;
 
+/* "libres" es NULL mientras no se llame a lista_reciclar_nodos, así las
+ * listas que no reciclan nodos no pagan por ello. */
 struct lista {
 	nodo_t* prim;
 	nodo_t* ult;
     size_t largo;
+    unsigned capacidad_nodo;
+    libres_t* libres;
 };
 
-struct lista_iter {
-	lista_t* lista;
-	nodo_t* act;
-	nodo_t* ant;
-};
+/* Devuelve un nodo vacío de la capacidad pedida, reutilizando uno libre si
+ * es de esa capacidad. Una lista puede tener nodos de otra capacidad que la
+ * suya si se le empalmó o concatenó una lista de otro tipo. */
+nodo_t* crear_nodo(lista_t* lista, unsigned capacidad) {
+    libres_t* libres = lista->libres;
+    nodo_t* nodo = libres && capacidad == lista->capacidad_nodo ? libres->nodos : NULL;
+    if (nodo){
+        libres->nodos = nodo->prox;
+        libres->cant--;
+    }
+    else{
+        size_t tam = sizeof(nodo_t) + capacidad * sizeof(void*);
+        if (capacidad == 1) nodo = malloc(tam);
+        else if (posix_memalign((void**)&nodo, TAM_LINEA_CACHE, tam)) nodo = NULL;
+        if (!nodo) return NULL;
+    }
+    nodo->prox = NULL;
+    nodo->cant = 0;
+    nodo->capacidad = capacidad;
+    return nodo;
+}
 
-nodo_t* crear_nodo(void* valor) { 
-    nodo_t* nodo = malloc(sizeof(nodo_t)); 
-    if (!nodo) return NULL; 
-    nodo->dato = valor; 
-    nodo->prox = NULL; 
-    return nodo; 
+void liberar_nodo(lista_t* lista, nodo_t* nodo) {
+    libres_t* libres = lista->libres;
+    if (libres && libres->cant < libres->maximo && nodo->capacidad == lista->capacidad_nodo){
+        nodo->prox = libres->nodos;
+        libres->nodos = nodo;
+        libres->cant++;
+    }
+    else free(nodo);
 }
 
-lista_t *lista_crear(void){
+lista_t* crear_lista(unsigned capacidad_nodo){
     lista_t* lista = malloc(sizeof(lista_t));
     if (!lista) return NULL;
 
     lista->prim = NULL;
     lista->ult = NULL;
     lista->largo = 0;
+    lista->capacidad_nodo = capacidad_nodo;
+    lista->libres = NULL;
 
     return lista;
 }
 
+lista_t *lista_crear(void){
+    return crear_lista(1);
+}
+
+lista_t *lista_crear_desenrollada(void){
+    return crear_lista((unsigned)CAPACIDAD_DESENROLLADA);
+}
+
+bool lista_reciclar_nodos(lista_t *lista, size_t maximo){
+    libres_t* libres = lista->libres;
+    if (!libres){
+        if (!maximo) return true;
+        libres = malloc(sizeof(libres_t));
+        if (!libres) return false;
+        libres->nodos = NULL;
+        libres->cant = 0;
+        lista->libres = libres;
+    }
+    libres->maximo = maximo;
+    while (libres->cant > maximo){
+        nodo_t* nodo = libres->nodos;
+        libres->nodos = nodo->prox;
+        libres->cant--;
+        free(nodo);
+    }
+    if (!maximo){
+        free(libres);
+        lista->libres = NULL;
+    }
+    return true;
+}
+
 bool lista_esta_vacia(const lista_t *lista){
     return !lista->prim;
 }
 
 bool lista_insertar_primero(lista_t *lista, void *dato){
-    nodo_t* nodo_nuevo = crear_nodo(dato);
-    if (!nodo_nuevo) return false;
+    nodo_t* nodo = lista->prim;
+    if (!nodo || nodo->cant == nodo->capacidad){
+        nodo = crear_nodo(lista, lista->capacidad_nodo);
+        if (!nodo) return false;
 
-    if (!lista->ult) lista->ult = nodo_nuevo;
+        if (!lista->ult) lista->ult = nodo;
 
-    nodo_nuevo->prox = lista->prim; //Funciona también para una lista vacía
-    lista->prim = nodo_nuevo;
+        nodo->prox = lista->prim; //Funciona también para una lista vacía
+        lista->prim = nodo;
+    }
+
+    memmove(&nodo->datos[1], &nodo->datos[0], nodo->cant * sizeof(void*));
+    nodo->datos[0] = dato;
+    nodo->cant++;
 
     lista->largo++;
 
@@ -59,14 +140,19 @@ bool lista_insertar_primero(lista_t *lista, void *dato){
 }
 
 bool lista_insertar_ultimo(lista_t *lista, void *dato){
-    nodo_t* nodo_nuevo = crear_nodo(dato);
-    if (!nodo_nuevo) return false;
+    nodo_t* nodo = lista->ult;
+    if (!nodo || nodo->cant == nodo->capacidad){
+        nodo = crear_nodo(lista, lista->capacidad_nodo);
+        if (!nodo) return false;
 
-    if (!lista->prim) lista->prim = nodo_nuevo;
+        if (!lista->prim) lista->prim = nodo;
 
-    else lista->ult->prox = nodo_nuevo;
-    
-    lista->ult = nodo_nuevo;
+        else lista->ult->prox = nodo;
+
+        lista->ult = nodo;
+    }
+
+    nodo->datos[nodo->cant++] = dato;
 
     lista->largo++;
 
@@ -76,26 +162,107 @@ bool lista_insertar_ultimo(lista_t *lista, void *dato){
 
 void *lista_borrar_primero(lista_t *lista){
     if (!lista->prim) return NULL;
-    nodo_t* nodo_borrado = lista->prim;
-    void* dato = lista->prim->dato;
-    lista->prim = lista->prim->prox;
-    if (!lista->prim) lista->ult = NULL;
-
-    free(nodo_borrado);
+    nodo_t* nodo = lista->prim;
+    void* dato = nodo->datos[0];
+    nodo->cant--;
+    memmove(&nodo->datos[0], &nodo->datos[1], nodo->cant * sizeof(void*));
+
+    if (!nodo->cant){
+        lista->prim = nodo->prox;
+        if (!lista->prim) lista->ult = NULL;
+        liberar_nodo(lista, nodo);
+    }
 
     lista->largo--;
 
     return dato;
 }
 
+bool lista_insertar_lote(lista_t *lista, void **datos, size_t cantidad){
+    nodo_t* ult = lista->ult;
+    size_t lugar = ult ? ult->capacidad - ult->cant : 0;
+    if (lugar > cantidad) lugar = cantidad;
+
+    // Se piden primero todos los nodos nuevos, para no insertar a medias
+    nodo_t* prim_nuevo = NULL;
+    nodo_t* ult_nuevo = NULL;
+    for (size_t i = lugar; i < cantidad; ){
+        nodo_t* nodo = crear_nodo(lista, lista->capacidad_nodo);
+        if (!nodo){
+            while (prim_nuevo){
+                nodo_t* prox = prim_nuevo->prox;
+                liberar_nodo(lista, prim_nuevo);
+                prim_nuevo = prox;
+            }
+            return false;
+        }
+        nodo->cant = (unsigned)(cantidad - i < nodo->capacidad ? cantidad - i : nodo->capacidad);
+        memcpy(nodo->datos, &datos[i], nodo->cant * sizeof(void*));
+        i += nodo->cant;
+        if (!prim_nuevo) prim_nuevo = nodo;
+        else ult_nuevo->prox = nodo;
+        ult_nuevo = nodo;
+    }
+
+    if (lugar){
+        memcpy(&ult->datos[ult->cant], datos, lugar * sizeof(void*));
+        ult->cant += (unsigned)lugar;
+    }
+    if (prim_nuevo){
+        if (!lista->prim) lista->prim = prim_nuevo;
+        else lista->ult->prox = prim_nuevo;
+        lista->ult = ult_nuevo;
+    }
+
+    lista->largo += cantidad;
+
+    return true;
+}
+
+void lista_concatenar(lista_t *lista, lista_t *otra){
+    if (!otra->prim) return;
+
+    if (!lista->prim) lista->prim = otra->prim;
+    else lista->ult->prox = otra->prim;
+    lista->ult = otra->ult;
+    lista->largo += otra->largo;
+
+    otra->prim = NULL;
+    otra->ult = NULL;
+    otra->largo = 0;
+}
+
+bool lista_mover_primero(lista_t *lista, lista_t *destino){
+    nodo_t* nodo = lista->prim;
+    if (!nodo) return false;
+    if (nodo->cant > 1){
+        // El nodo tiene otros datos: se copia el primero y queda en la lista
+        if (!lista_insertar_ultimo(destino, nodo->datos[0])) return false;
+        lista_borrar_primero(lista);
+        return true;
+    }
+
+    lista->prim = nodo->prox;
+    if (!lista->prim) lista->ult = NULL;
+    lista->largo--;
+
+    nodo->prox = NULL;
+    if (!destino->prim) destino->prim = nodo;
+    else destino->ult->prox = nodo;
+    destino->ult = nodo;
+    destino->largo++;
+
+    return true;
+}
+
 void *lista_ver_primero(const lista_t *lista){
     if (!lista->prim) return NULL;
-    return lista->prim->dato;
+    return lista->prim->datos[0];
 }
 
 void *lista_ver_ultimo(const lista_t* lista){
     if (!lista->prim) return NULL;
-    return lista->ult->dato;
+    return lista->ult->datos[lista->ult->cant - 1];
 }
 
 size_t lista_largo(const lista_t *lista){
@@ -103,17 +270,23 @@ size_t lista_largo(const lista_t *lista){
 }
 
 void lista_destruir(lista_t *lista, void(*destruir_dato)(void *)){
-    while (!lista_esta_vacia(lista)){
-        void* dato = lista_borrar_primero(lista);
-        if (destruir_dato != NULL) destruir_dato(dato);
+    nodo_t* act = lista->prim;
+    while (act){
+        nodo_t* prox = act->prox;
+        for (unsigned i = 0; destruir_dato && i < act->cant; i++) destruir_dato(act->datos[i]);
+        free(act);
+        act = prox;
     }
+    lista_reciclar_nodos(lista, 0);
     free(lista);
 }
 
 void lista_iterar(lista_t *lista, bool (*visitar)(void *dato, void *extra), void *extra){
     nodo_t* act = lista->prim;
     while (act){
-        if (!visitar(act->dato, extra)) break;
+        for (unsigned i = 0; i < act->cant; i++){
+            if (!visitar(act->datos[i], extra)) return;
+        }
         act = act->prox;
     }
 }
@@ -122,63 +295,157 @@ lista_iter_t *lista_iter_crear(lista_t *lista){
     lista_iter_t* iter = malloc(sizeof(lista_iter_t));
     if (!iter) return NULL;
 
+    lista_iter_inicializar(iter, lista);
+
+    return iter;
+}
+
+void lista_iter_inicializar(lista_iter_t *iter, lista_t *lista){
     iter->lista = lista;
     iter->act = lista->prim;
     iter->ant = NULL;
+    iter->pos = 0;
+}
 
-    return iter;
+/* Pasado el último dato de un nodo, el iterador sigue en el nodo siguiente.
+ * Si no hay siguiente y el nodo tiene lugar, se queda en él con pos igual a
+ * cant, así insertar al final llena ese nodo sin perder su anterior. */
+void iter_pasar_nodo(lista_iter_t *iter){
+    nodo_t* act = iter->act;
+    if (iter->pos < act->cant || (!act->prox && act->cant < act->capacidad)) return;
+    iter->ant = act;
+    iter->act = act->prox;
+    iter->pos = 0;
 }
 
 bool lista_iter_avanzar(lista_iter_t *iter){
-    if (!iter->act) return false;
-    iter->ant = iter->act;
-    iter->act = iter->act->prox;
+    if (lista_iter_al_final(iter)) return false;
+    iter->pos++;
+    iter_pasar_nodo(iter);
     return true;
 }
 
 void *lista_iter_ver_actual(const lista_iter_t *iter){
-    if (!iter->act) return NULL;
-    return iter->act->dato;
+    if (lista_iter_al_final(iter)) return NULL;
+    return iter->act->datos[iter->pos];
 }
 
 bool lista_iter_al_final(const lista_iter_t *iter){
-    return !iter->act;
+    return !iter->act || iter->pos == iter->act->cant;
 }
 
 void lista_iter_destruir(lista_iter_t *iter){
     free(iter);
 }
 
-bool lista_iter_insertar(lista_iter_t *iter, void *dato){
-    nodo_t* nodo_nuevo = crear_nodo(dato);
+/* Enlaza un nodo nuevo con el dato entre el anterior y el actual */
+bool iter_insertar_nodo(lista_iter_t *iter, void *dato){
+    nodo_t* nodo_nuevo = crear_nodo(iter->lista, iter->lista->capacidad_nodo);
     if (!nodo_nuevo) return false;
+    nodo_nuevo->datos[nodo_nuevo->cant++] = dato;
 
     if (!iter->ant) iter->lista->prim = nodo_nuevo;
     else iter->ant->prox = nodo_nuevo;
     nodo_nuevo->prox = iter->act;
-    iter->act = nodo_nuevo;
     if (!nodo_nuevo->prox) iter->lista->ult = nodo_nuevo;
+    iter->act = nodo_nuevo;
+    iter->pos = 0;
+    return true;
+}
 
-    iter->lista->largo++;
+/* Parte el nodo actual en la posición del iterador, pasando los datos
+ * desde esa posición en adelante a un nodo nuevo a continuación, de la
+ * misma capacidad que el actual. */
+bool iter_partir_nodo(lista_iter_t *iter){
+    nodo_t* nodo_nuevo = crear_nodo(iter->lista, iter->act->capacidad);
+    if (!nodo_nuevo) return false;
 
+    nodo_t* act = iter->act;
+    nodo_nuevo->cant = act->cant - iter->pos;
+    memcpy(nodo_nuevo->datos, &act->datos[iter->pos], nodo_nuevo->cant * sizeof(void*));
+    act->cant = iter->pos;
+    nodo_nuevo->prox = act->prox;
+    act->prox = nodo_nuevo;
+    if (iter->lista->ult == act) iter->lista->ult = nodo_nuevo;
     return true;
 }
 
-void *lista_iter_borrar(lista_iter_t *iter){
-    if (!iter->act) return NULL;
+bool lista_iter_insertar(lista_iter_t *iter, void *dato){
+    nodo_t* act = iter->act;
 
-    nodo_t* nodo_borrado = iter->act;
-    void* dato = iter->act->dato;
-    
-    if (!iter->ant) iter->lista->prim = iter->act->prox;
-    else iter->ant->prox = iter->act->prox;    
+    if (!act){
+        if (!iter_insertar_nodo(iter, dato)) return false;
+    }
+    else if (act->cant < act->capacidad){
+        memmove(&act->datos[iter->pos + 1], &act->datos[iter->pos], (act->cant - iter->pos) * sizeof(void*));
+        act->datos[iter->pos] = dato;
+        act->cant++;
+    }
+    else if (!iter->pos){
+        if (!iter_insertar_nodo(iter, dato)) return false;
+    }
+    else{
+        if (!iter_partir_nodo(iter)) return false;
+        act->datos[act->cant++] = dato;
+    }
 
-    iter->act = iter->act->prox;
-    if(!iter->act) iter->lista->ult = iter->ant;
+    iter->lista->largo++;
 
-    free(nodo_borrado);
+    return true;
+}
+
+void *lista_iter_borrar(lista_iter_t *iter){
+    if (lista_iter_al_final(iter)) return NULL;
+
+    nodo_t* act = iter->act;
+    void* dato = act->datos[iter->pos];
+    act->cant--;
+    memmove(&act->datos[iter->pos], &act->datos[iter->pos + 1], (act->cant - iter->pos) * sizeof(void*));
+
+    if (!act->cant){
+        if (!iter->ant) iter->lista->prim = act->prox;
+        else iter->ant->prox = act->prox;
+        if (iter->lista->ult == act) iter->lista->ult = iter->ant;
+        iter->act = act->prox;
+        liberar_nodo(iter->lista, act);
+    }
+    else iter_pasar_nodo(iter);
 
     iter->lista->largo--;
-    
+
     return dato;
-}
\ No newline at end of file
+}
+
+bool lista_iter_empalmar(lista_iter_t *iter, lista_t *otra){
+    if (!otra->prim) return true;
+
+    // Si el iterador está al final pero sobre el último nodo, se lo saca de él
+    if (iter->act && iter->pos == iter->act->cant){
+        iter->ant = iter->act;
+        iter->act = NULL;
+        iter->pos = 0;
+    }
+    // Si el iterador está en medio de un nodo, se lo parte en esa posición
+    if (iter->act && iter->pos){
+        if (!iter_partir_nodo(iter)) return false;
+        iter->ant = iter->act;
+        iter->act = iter->act->prox;
+        iter->pos = 0;
+    }
+
+    nodo_t* anterior = iter->act ? iter->ant : iter->lista->ult;
+    if (!anterior) iter->lista->prim = otra->prim;
+    else anterior->prox = otra->prim;
+    otra->ult->prox = iter->act;
+    if (!iter->act) iter->lista->ult = otra->ult;
+
+    iter->ant = anterior;
+    iter->act = otra->prim;
+    iter->lista->largo += otra->largo;
+
+    otra->prim = NULL;
+    otra->ult = NULL;
+    otra->largo = 0;
+
+    return true;
+}
@@ -1,3 +1,6 @@
+#ifndef LISTA_H
+#define LISTA_H
+
 #include <stdlib.h>
 #include <stdbool.h>
 
@@ -11,6 +14,15 @@
 typedef struct lista lista_t;
 typedef struct lista_iter lista_iter_t;
 
+/* La definición del iterador es pública sólo para poder declararlo en el
+ * stack con lista_iter_inicializar; sus campos no deben usarse. */
+struct lista_iter {
+	lista_t* lista;
+	struct nodo* act;
+	struct nodo* ant;
+	unsigned pos;
+};
+
 
 /* ******************************************************************
  *                    PRIMITIVAS DE LA LISTA
@@ -20,6 +32,21 @@ typedef struct lista_iter lista_iter_t;
 // Post: devuelve una nueva lista vacía.
 lista_t* lista_crear(void);
 
+// Crea una lista desenrollada: cada nodo guarda tantos datos como entran en
+// una línea de caché, por lo que recorrerla requiere menos accesos a memoria
+// y pedidos de memoria. Admite las mismas primitivas que una lista común.
+// Post: devuelve una nueva lista desenrollada vacía.
+lista_t* lista_crear_desenrollada(void);
+
+// Establece la cantidad máxima de nodos que la lista conserva al borrar
+// elementos, para reutilizarlos en las próximas inserciones sin pedir memoria.
+// Por omisión es 0: los nodos se liberan apenas se vacían, y la lista no
+// ocupa memoria de más. Devuelve falso si no hubo memoria para empezar a
+// reciclar.
+// Pre: la lista fue creada.
+// Post: la lista conserva a lo sumo maximo nodos libres.
+bool lista_reciclar_nodos(lista_t *lista, size_t maximo);
+
 // Destruye la lista. Si se recibe la función destruir_dato por parámetro,
 // para cada uno de los elementos de la lista llama a destruir_dato.
 // Pre: la lista fue creada. destruir_dato es una función capaz de destruir
@@ -41,6 +68,26 @@ bool lista_insertar_primero(lista_t *lista, void *dato);
 // Post: se insertó un nuevo elemento al final de la lista.
 bool lista_insertar_ultimo(lista_t *lista, void *dato);
 
+// Inserta al final de la lista los cantidad elementos del arreglo datos, en
+// orden. Si no puede insertarlos todos no inserta ninguno y devuelve falso.
+// Pre: la lista fue creada, datos tiene al menos cantidad elementos.
+// Post: se insertaron los elementos al final de la lista.
+bool lista_insertar_lote(lista_t *lista, void **datos, size_t cantidad);
+
+// Mueve todos los elementos de otra al final de la lista, en tiempo constante
+// y sin pedir memoria.
+// Pre: ambas listas fueron creadas y son distintas.
+// Post: la lista tiene al final los elementos de otra, y otra quedó vacía.
+void lista_concatenar(lista_t *lista, lista_t *otra);
+
+// Mueve el primer elemento de la lista al final de destino. Si su nodo no
+// guarda otros elementos, lo mueve sin pedir memoria. Devuelve falso si la
+// lista estaba vacía o en caso de error.
+// Pre: ambas listas fueron creadas. Si son la misma, el primer elemento
+// pasa a ser el último.
+// Post: el primer elemento de la lista pasó a ser el último de destino.
+bool lista_mover_primero(lista_t *lista, lista_t *destino);
+
 // Obtiene el valor del primer elemento de la lista. Si la lista tiene
 // elementos, se devuelve el valor del primero, si está vacía devuelve NULL.
 // Pre: la lista fue creada.
@@ -72,6 +119,13 @@ size_t lista_largo(const lista_t *lista);
 // Post: devuelve un iterador de lista que comienza en el elemento 0.
 lista_iter_t *lista_iter_crear(lista_t *lista);
 
+// Inicializa un iterador de lista provisto por el llamador, por ejemplo
+// declarado en el stack. No pide memoria, y no debe destruirse con
+// lista_iter_destruir.
+// Pre: la lista fue creada.
+// Post: el iterador comienza en el elemento 0 de la lista.
+void lista_iter_inicializar(lista_iter_t *iter, lista_t *lista);
+
 // Avanza el iterador de lista en una posición. Devuelve falso en caso de que
 // ya estuviera en la última.
 // Pre: el iterador fue creado.
@@ -108,6 +162,15 @@ bool lista_iter_insertar(lista_iter_t *iter, void *dato);
 //  era la última.
 void *lista_iter_borrar(lista_iter_t *iter);
 
+// Mueve todos los elementos de otra a la posición en que se encuentra el
+// iterador, en tiempo constante. Sólo pide memoria si el iterador está en
+// medio de un nodo de una lista desenrollada. Devuelve falso en caso de error.
+// Pre: el iterador fue creado, otra fue creada y no es la lista del iterador.
+// Post: se insertaron los elementos de otra en la posición actual del
+// iterador, que queda sobre el primero de ellos si otra no estaba vacía;
+// otra quedó vacía.
+bool lista_iter_empalmar(lista_iter_t *iter, lista_t *otra);
+
 // Aplica la función "visitar" a todos los elementos de la lista. Opcionalmente,
 // puede recibir una condición de corte mediante el parámetro extra.
 // Pre: la lista fue creada.
@@ -126,4 +189,6 @@ void lista_iterar(lista_t *lista, bool (*visitar)(void *dato, void *extra), void
 //
 // Para la implementación de las pruebas se debe emplear la función
 // print_test(), como se ha visto en TPs anteriores.
-void pruebas_lista_alumno(void);
\ No newline at end of file
+void pruebas_lista_alumno(void);
+
+#endif // LISTA_H
@@ -0,0 +1,402 @@
+/*
+ * lista_pruebas.c
+ * Pruebas para el tipo de dato abstracto Lista Enlazada
+ */
+
+#include "lista.h"
+#include "testing.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* ******************************************************************
+ *                        FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Los datos de las pruebas son enteros guardados en los punteros. */
+#define DATO(n) ((void*)(intptr_t)(n))
+
+/* Devuelve true si la lista tiene exactamente los datos 0 .. largo - 1
+ * desplazados en "inicio", recorriéndola con un iterador en el stack. */
+static bool lista_es_secuencia(lista_t *lista, intptr_t inicio, size_t largo)
+{
+    if (lista_largo(lista) != largo) return false;
+
+    lista_iter_t iter;
+    lista_iter_inicializar(&iter, lista);
+    for (size_t i = 0; i < largo; i++) {
+        if (lista_iter_ver_actual(&iter) != DATO(inicio + (intptr_t)i)) return false;
+        lista_iter_avanzar(&iter);
+    }
+    return lista_iter_al_final(&iter);
+}
+
+static bool sumar_dato(void *dato, void *extra)
+{
+    *(intptr_t*)extra += (intptr_t)dato;
+    return true;
+}
+
+/* ******************************************************************
+ *                        PRUEBAS UNITARIAS
+ * *****************************************************************/
+
+static void prueba_lista_vacia(lista_t *lista)
+{
+    print_test("Prueba lista crear lista vacia", lista);
+    print_test("Prueba lista esta vacia", lista_esta_vacia(lista));
+    print_test("Prueba lista largo es 0", lista_largo(lista) == 0);
+    print_test("Prueba lista ver primero es NULL", !lista_ver_primero(lista));
+    print_test("Prueba lista ver ultimo es NULL", !lista_ver_ultimo(lista));
+    print_test("Prueba lista borrar primero es NULL", !lista_borrar_primero(lista));
+}
+
+static void prueba_lista_desenrollada(size_t largo)
+{
+    lista_t* lista = lista_crear_desenrollada();
+    prueba_lista_vacia(lista);
+
+    /* Inserta por ambos extremos, cruzando varios nodos */
+    bool ok = true;
+    for (size_t i = largo / 2; i < largo; i++) ok &= lista_insertar_ultimo(lista, DATO(i));
+    for (size_t i = largo / 2; i > 0; i--) ok &= lista_insertar_primero(lista, DATO(i - 1));
+    print_test("Prueba lista desenrollada insertar muchos elementos", ok);
+    print_test("Prueba lista desenrollada mantiene el orden", lista_es_secuencia(lista, 0, largo));
+    print_test("Prueba lista desenrollada ver primero", lista_ver_primero(lista) == DATO(0));
+    print_test("Prueba lista desenrollada ver ultimo", lista_ver_ultimo(lista) == DATO(largo - 1));
+
+    intptr_t suma = 0;
+    lista_iterar(lista, sumar_dato, &suma);
+    print_test("Prueba lista desenrollada iterar visita todos", suma == (intptr_t)(largo * (largo - 1) / 2));
+
+    /* Borra con el iterador los impares, vaciando y partiendo nodos */
+    lista_iter_t* iter = lista_iter_crear(lista);
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 2) ok &= lista_iter_borrar(iter) == DATO(i);
+        else lista_iter_avanzar(iter);
+    }
+    print_test("Prueba lista desenrollada iter borrar impares", ok && lista_iter_al_final(iter));
+    lista_iter_destruir(iter);
+    print_test("Prueba lista desenrollada largo es la mitad", lista_largo(lista) == (largo + 1) / 2);
+
+    /* Vuelve a insertarlos con el iterador, en medio de nodos llenos */
+    iter = lista_iter_crear(lista);
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 2) ok &= lista_iter_insertar(iter, DATO(i));
+        lista_iter_avanzar(iter);
+    }
+    lista_iter_destruir(iter);
+    print_test("Prueba lista desenrollada iter insertar impares", ok);
+    print_test("Prueba lista desenrollada recupera el orden", lista_es_secuencia(lista, 0, largo));
+
+    ok = true;
+    for (size_t i = 0; i < largo; i++) ok &= lista_borrar_primero(lista) == DATO(i);
+    print_test("Prueba lista desenrollada borrar primero todos", ok);
+    prueba_lista_vacia(lista);
+
+    /* Insertar al final con el iterador sobre una lista vacía */
+    iter = lista_iter_crear(lista);
+    ok = true;
+    for (size_t i = 0; i < largo; i++) ok &= lista_iter_insertar(iter, DATO(largo - 1 - i));
+    lista_iter_destruir(iter);
+    ok &= lista_ver_primero(lista) == DATO(0) && lista_ver_ultimo(lista) == DATO(largo - 1);
+    print_test("Prueba lista desenrollada iter insertar siempre adelante", ok && lista_es_secuencia(lista, 0, largo));
+
+    lista_destruir(lista, NULL);
+}
+
+/* Un iterador al final de una lista desenrollada se queda sobre el último
+ * nodo mientras tenga lugar: insertar, borrar y empalmar desde ahí deben
+ * dejar la lista bien enlazada. */
+static void prueba_lista_iter_al_final(size_t largo)
+{
+    lista_t* lista = lista_crear_desenrollada();
+    lista_t* otra = lista_crear_desenrollada();
+    lista_iter_t iter;
+    lista_iter_inicializar(&iter, lista);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        ok &= lista_iter_insertar(&iter, DATO(i)) && lista_iter_ver_actual(&iter) == DATO(i);
+        ok &= lista_iter_avanzar(&iter) && lista_iter_al_final(&iter) && !lista_iter_ver_actual(&iter);
+    }
+    print_test("Prueba lista iter al final insertar y avanzar", ok && lista_es_secuencia(lista, 0, largo));
+    print_test("Prueba lista iter al final avanzar es false", !lista_iter_avanzar(&iter));
+    print_test("Prueba lista iter al final borrar es NULL", !lista_iter_borrar(&iter) && lista_largo(lista) == largo);
+
+    /* Borrar el último dato deja al iterador otra vez al final */
+    ok = lista_iter_insertar(&iter, DATO(largo)) && lista_iter_borrar(&iter) == DATO(largo);
+    print_test("Prueba lista iter al final borrar lo insertado", ok && lista_iter_al_final(&iter) && lista_es_secuencia(lista, 0, largo));
+
+    for (size_t i = largo; i < 2 * largo; i++) lista_insertar_ultimo(otra, DATO(i));
+    ok = lista_iter_empalmar(&iter, otra) && lista_iter_ver_actual(&iter) == DATO(largo);
+    print_test("Prueba lista iter al final empalmar", ok && lista_es_secuencia(lista, 0, 2 * largo));
+    ok = lista_insertar_ultimo(lista, DATO(2 * largo)) && lista_ver_ultimo(lista) == DATO(2 * largo);
+    print_test("Prueba lista iter al final insertar ultimo tras empalmar", ok && lista_es_secuencia(lista, 0, 2 * largo + 1));
+
+    /* Borrar todo desde el principio, vaciando y liberando cada nodo */
+    lista_iter_inicializar(&iter, lista);
+    ok = true;
+    for (size_t i = 0; i <= 2 * largo; i++) ok &= lista_iter_borrar(&iter) == DATO(i);
+    print_test("Prueba lista iter al final borrar todo", ok && lista_iter_al_final(&iter));
+    prueba_lista_vacia(lista);
+
+    lista_destruir(lista, NULL);
+    lista_destruir(otra, NULL);
+}
+
+static void prueba_lista_reciclar_nodos(size_t largo)
+{
+    lista_t* comun = lista_crear();
+    lista_t* desenrollada = lista_crear_desenrollada();
+    print_test("Prueba lista reciclar nodos activar", lista_reciclar_nodos(comun, 8) && lista_reciclar_nodos(desenrollada, 8));
+
+    /* Uso de cola: cada vuelta reutiliza los nodos que liberó la anterior */
+    bool ok = true;
+    for (size_t vuelta = 0; vuelta < 4; vuelta++) {
+        for (size_t i = 0; i < largo; i++) {
+            ok &= lista_insertar_ultimo(comun, DATO(i));
+            ok &= lista_insertar_ultimo(desenrollada, DATO(i));
+        }
+        for (size_t i = 0; i < largo; i++) {
+            ok &= lista_borrar_primero(comun) == DATO(i);
+            ok &= lista_borrar_primero(desenrollada) == DATO(i);
+        }
+    }
+    print_test("Prueba lista reciclar nodos en uso de cola", ok);
+    print_test("Prueba lista reciclar nodos quedan vacias", lista_esta_vacia(comun) && lista_esta_vacia(desenrollada));
+
+    /* Los nodos reciclados se usan igual por los dos extremos */
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        ok &= lista_insertar_primero(comun, DATO(largo - 1 - i));
+        ok &= lista_insertar_primero(desenrollada, DATO(largo - 1 - i));
+    }
+    print_test("Prueba lista reciclar nodos insertar primero", ok);
+    print_test("Prueba lista reciclar nodos orden comun", lista_es_secuencia(comun, 0, largo));
+    print_test("Prueba lista reciclar nodos orden desenrollada", lista_es_secuencia(desenrollada, 0, largo));
+
+    /* Bajar el máximo libera los nodos sobrantes; luego se destruye con
+     * nodos libres pendientes */
+    lista_reciclar_nodos(comun, 0);
+    while (!lista_esta_vacia(comun)) lista_borrar_primero(comun);
+    while (!lista_esta_vacia(desenrollada)) lista_borrar_primero(desenrollada);
+    print_test("Prueba lista reciclar nodos insertar tras bajar el maximo", lista_insertar_ultimo(comun, DATO(1)));
+    print_test("Prueba lista reciclar nodos ver primero", lista_ver_primero(comun) == DATO(1));
+
+    /* Se puede volver a activar después de desactivarlo */
+    ok = lista_reciclar_nodos(comun, 0) && lista_reciclar_nodos(comun, 2);
+    for (size_t i = 0; i < largo; i++) ok &= lista_insertar_ultimo(comun, DATO(i + 2));
+    for (size_t i = 0; i < largo; i++) ok &= lista_borrar_primero(comun) == DATO(i + 1);
+    ok &= lista_insertar_ultimo(comun, DATO(0)) && lista_ver_primero(comun) == DATO(largo + 1);
+    print_test("Prueba lista reciclar nodos volver a activar", ok && lista_largo(comun) == 2);
+
+    lista_destruir(comun, NULL);
+    lista_destruir(desenrollada, NULL);
+}
+
+static void prueba_lista_iter_inicializar(lista_t *lista)
+{
+    lista_iter_t iter;
+    lista_iter_inicializar(&iter, lista);
+    print_test("Prueba lista iter inicializar en lista vacia esta al final", lista_iter_al_final(&iter));
+    print_test("Prueba lista iter inicializar ver actual es NULL", !lista_iter_ver_actual(&iter));
+    print_test("Prueba lista iter inicializar avanzar es false", !lista_iter_avanzar(&iter));
+
+    /* Inserta 0, 2, 3 y luego el 1 en medio con el mismo iterador */
+    bool ok = lista_iter_insertar(&iter, DATO(3));
+    ok &= lista_iter_insertar(&iter, DATO(2));
+    ok &= lista_iter_insertar(&iter, DATO(0));
+    ok &= lista_iter_avanzar(&iter);
+    ok &= lista_iter_insertar(&iter, DATO(1));
+    print_test("Prueba lista iter inicializar insertar", ok);
+    print_test("Prueba lista iter inicializar ver actual", lista_iter_ver_actual(&iter) == DATO(1));
+    print_test("Prueba lista iter inicializar orden", lista_es_secuencia(lista, 0, 4));
+
+    /* Un segundo iterador en el stack borra el primero y el último */
+    lista_iter_t otro;
+    lista_iter_inicializar(&otro, lista);
+    print_test("Prueba lista iter inicializar borrar primero", lista_iter_borrar(&otro) == DATO(0));
+    lista_iter_avanzar(&otro);
+    lista_iter_avanzar(&otro);
+    print_test("Prueba lista iter inicializar borrar ultimo", lista_iter_borrar(&otro) == DATO(3));
+    print_test("Prueba lista iter inicializar queda al final", lista_iter_al_final(&otro));
+    print_test("Prueba lista iter inicializar ver ultimo", lista_ver_ultimo(lista) == DATO(2));
+    print_test("Prueba lista iter inicializar orden tras borrar", lista_es_secuencia(lista, 1, 2));
+
+    lista_destruir(lista, NULL);
+}
+
+static void prueba_lista_insertar_lote(lista_t *lista, size_t largo)
+{
+    void** datos = malloc(largo * sizeof(void*));
+    for (size_t i = 0; i < largo; i++) datos[i] = DATO(i);
+
+    print_test("Prueba lista insertar lote vacio", lista_insertar_lote(lista, datos, 0) && lista_esta_vacia(lista));
+    print_test("Prueba lista insertar lote de uno", lista_insertar_lote(lista, datos, 1));
+    print_test("Prueba lista insertar lote completa el ultimo nodo", lista_insertar_lote(lista, &datos[1], 2));
+    print_test("Prueba lista insertar lote grande", lista_insertar_lote(lista, &datos[3], largo - 3));
+    print_test("Prueba lista insertar lote mantiene el orden", lista_es_secuencia(lista, 0, largo));
+    print_test("Prueba lista insertar lote ver ultimo", lista_ver_ultimo(lista) == DATO(largo - 1));
+    print_test("Prueba lista insertar lote insertar ultimo despues", lista_insertar_ultimo(lista, DATO(largo)));
+    print_test("Prueba lista insertar lote orden final", lista_es_secuencia(lista, 0, largo + 1));
+
+    free(datos);
+    lista_destruir(lista, NULL);
+}
+
+static void prueba_lista_concatenar(lista_t *lista, lista_t *otra, size_t largo)
+{
+    lista_concatenar(lista, otra);
+    print_test("Prueba lista concatenar vacias", lista_esta_vacia(lista) && lista_esta_vacia(otra));
+
+    for (size_t i = 0; i < largo; i++) lista_insertar_ultimo(otra, DATO(i));
+    lista_concatenar(lista, otra);
+    print_test("Prueba lista concatenar a una vacia", lista_es_secuencia(lista, 0, largo));
+    print_test("Prueba lista concatenar deja la otra vacia", lista_esta_vacia(otra) && !lista_ver_ultimo(otra));
+
+    for (size_t i = largo; i < 2 * largo; i++) lista_insertar_ultimo(otra, DATO(i));
+    lista_concatenar(lista, otra);
+    print_test("Prueba lista concatenar al final", lista_es_secuencia(lista, 0, 2 * largo));
+    print_test("Prueba lista concatenar ver ultimo", lista_ver_ultimo(lista) == DATO(2 * largo - 1));
+
+    lista_concatenar(lista, otra);
+    print_test("Prueba lista concatenar otra vacia no cambia", lista_largo(lista) == 2 * largo);
+
+    /* Ambas listas siguen siendo usables */
+    print_test("Prueba lista concatenar insertar en la otra", lista_insertar_ultimo(otra, DATO(0)));
+    print_test("Prueba lista concatenar insertar al final", lista_insertar_ultimo(lista, DATO(2 * largo)));
+    print_test("Prueba lista concatenar orden final", lista_es_secuencia(lista, 0, 2 * largo + 1));
+
+    lista_destruir(lista, NULL);
+    lista_destruir(otra, NULL);
+}
+
+static void prueba_lista_iter_empalmar(lista_t *lista, lista_t *otra, size_t largo)
+{
+    /* Arma 0 .. largo - 1 empalmando el tramo del medio, luego el
+     * principio y por último el final */
+    size_t tercio = largo / 3;
+    for (size_t i = tercio; i < 2 * tercio; i++) lista_insertar_ultimo(otra, DATO(i));
+    lista_iter_t iter;
+    lista_iter_inicializar(&iter, lista);
+    print_test("Prueba lista iter empalmar en lista vacia", lista_iter_empalmar(&iter, otra));
+    print_test("Prueba lista iter empalmar queda sobre el primero", lista_iter_ver_actual(&iter) == DATO(tercio));
+    print_test("Prueba lista iter empalmar deja la otra vacia", lista_esta_vacia(otra));
+
+    for (size_t i = 0; i < tercio; i++) lista_insertar_ultimo(otra, DATO(i));
+    print_test("Prueba lista iter empalmar al principio", lista_iter_empalmar(&iter, otra));
+    print_test("Prueba lista iter empalmar ver primero", lista_ver_primero(lista) == DATO(0));
+
+    for (size_t i = 2 * tercio; i < largo; i++) lista_insertar_ultimo(otra, DATO(i));
+    while (!lista_iter_al_final(&iter)) lista_iter_avanzar(&iter);
+    print_test("Prueba lista iter empalmar al final", lista_iter_empalmar(&iter, otra));
+    print_test("Prueba lista iter empalmar orden", lista_es_secuencia(lista, 0, largo));
+    print_test("Prueba lista iter empalmar ver ultimo", lista_ver_ultimo(lista) == DATO(largo - 1));
+
+    /* Empalma en medio de un nodo: saca los datos 1 y 2 y los vuelve a
+     * poner entre el 0 y el 3 */
+    lista_iter_inicializar(&iter, lista);
+    lista_iter_avanzar(&iter);
+    lista_insertar_ultimo(otra, lista_iter_borrar(&iter));
+    lista_insertar_ultimo(otra, lista_iter_borrar(&iter));
+    print_test("Prueba lista iter empalmar en medio", lista_iter_empalmar(&iter, otra));
+    print_test("Prueba lista iter empalmar en medio ver actual", lista_iter_ver_actual(&iter) == DATO(1));
+    print_test("Prueba lista iter empalmar en medio orden", lista_es_secuencia(lista, 0, largo));
+
+    print_test("Prueba lista iter empalmar otra vacia", lista_iter_empalmar(&iter, otra));
+    print_test("Prueba lista iter empalmar otra vacia no cambia", lista_es_secuencia(lista, 0, largo));
+
+    lista_destruir(lista, NULL);
+    lista_destruir(otra, NULL);
+}
+
+static void prueba_lista_mover_primero(lista_t *lista, lista_t *destino, size_t largo)
+{
+    print_test("Prueba lista mover primero de lista vacia es false", !lista_mover_primero(lista, destino));
+
+    for (size_t i = 0; i < largo; i++) lista_insertar_ultimo(lista, DATO(i));
+    bool ok = true;
+    for (size_t i = 0; i < largo / 2; i++) ok &= lista_mover_primero(lista, destino);
+    print_test("Prueba lista mover primero la mitad", ok);
+    print_test("Prueba lista mover primero orden del destino", lista_es_secuencia(destino, 0, largo / 2));
+    print_test("Prueba lista mover primero orden del origen", lista_es_secuencia(lista, (intptr_t)(largo / 2), largo - largo / 2));
+
+    /* Sobre la misma lista, el primero pasa a ser el último */
+    ok = true;
+    for (size_t i = 0; i < largo / 2; i++) ok &= lista_mover_primero(destino, destino);
+    print_test("Prueba lista mover primero en la misma lista", ok);
+    print_test("Prueba lista mover primero en la misma lista orden", lista_es_secuencia(destino, 0, largo / 2));
+
+    ok = true;
+    while (!lista_esta_vacia(lista)) ok &= lista_mover_primero(lista, destino);
+    print_test("Prueba lista mover primero todos", ok && lista_es_secuencia(destino, 0, largo));
+    print_test("Prueba lista mover primero deja el origen vacio", !lista_ver_primero(lista) && !lista_ver_ultimo(lista));
+    print_test("Prueba lista mover primero origen usable", lista_insertar_ultimo(lista, DATO(0)));
+
+    lista_destruir(lista, NULL);
+    lista_destruir(destino, NULL);
+}
+
+static void prueba_lista_mezclada(size_t largo)
+{
+    /* Arma los pares 0 .. 4 * largo - 2 en una lista común, con tramos de
+     * nodos desenrollados llenos concatenados al final y empalmados en medio */
+    lista_t* lista = lista_crear();
+    lista_t* otra = lista_crear_desenrollada();
+    for (size_t i = 0; i < largo / 2; i++) lista_insertar_ultimo(lista, DATO(2 * i));
+    for (size_t i = largo; i < largo + largo / 2; i++) lista_insertar_ultimo(lista, DATO(2 * i));
+    for (size_t i = largo + largo / 2; i < 2 * largo; i++) lista_insertar_ultimo(otra, DATO(2 * i));
+    lista_concatenar(lista, otra);
+
+    for (size_t i = largo / 2; i < largo; i++) lista_insertar_ultimo(otra, DATO(2 * i));
+    lista_iter_t iter;
+    lista_iter_inicializar(&iter, lista);
+    for (size_t i = 0; i < largo / 2; i++) lista_iter_avanzar(&iter);
+    print_test("Prueba lista mezclada empalmar desenrollada", lista_iter_empalmar(&iter, otra));
+    print_test("Prueba lista mezclada largo tras empalmar", lista_largo(lista) == 2 * largo);
+
+    /* Inserta cada impar tras su par: en los tramos desenrollados, el
+     * iterador parte nodos llenos de otra capacidad que la de la lista */
+    lista_iter_inicializar(&iter, lista);
+    bool ok = true;
+    for (size_t i = 0; i < 2 * largo; i++) {
+        ok &= lista_iter_avanzar(&iter);
+        ok &= lista_iter_insertar(&iter, DATO(2 * i + 1));
+        ok &= lista_iter_avanzar(&iter);
+    }
+    print_test("Prueba lista mezclada iter insertar en nodos desenrollados", ok);
+    print_test("Prueba lista mezclada orden", lista_es_secuencia(lista, 0, 4 * largo));
+
+    /* Mueve y concatena de vuelta a una lista desenrollada y la vacía */
+    ok = lista_mover_primero(lista, otra);
+    lista_concatenar(otra, lista);
+    lista_iter_inicializar(&iter, otra);
+    for (size_t i = 0; i < 4 * largo; i++) ok &= lista_iter_borrar(&iter) == DATO(i);
+    print_test("Prueba lista mezclada borrar todos", ok && lista_esta_vacia(otra));
+
+    lista_destruir(lista, NULL);
+    lista_destruir(otra, NULL);
+}
+
+void pruebas_lista_alumno()
+{
+    /* Ejecuta todas las pruebas unitarias. */
+    prueba_lista_desenrollada(1000);
+    prueba_lista_iter_al_final(100);
+    prueba_lista_reciclar_nodos(1000);
+    prueba_lista_iter_inicializar(lista_crear());
+    prueba_lista_iter_inicializar(lista_crear_desenrollada());
+    prueba_lista_insertar_lote(lista_crear(), 100);
+    prueba_lista_insertar_lote(lista_crear_desenrollada(), 100);
+    prueba_lista_concatenar(lista_crear(), lista_crear(), 100);
+    prueba_lista_concatenar(lista_crear_desenrollada(), lista_crear_desenrollada(), 100);
+    prueba_lista_iter_empalmar(lista_crear(), lista_crear(), 100);
+    prueba_lista_iter_empalmar(lista_crear_desenrollada(), lista_crear_desenrollada(), 100);
+    prueba_lista_mover_primero(lista_crear(), lista_crear(), 100);
+    prueba_lista_mover_primero(lista_crear_desenrollada(), lista_crear_desenrollada(), 100);
+    prueba_lista_mezclada(100);
+}
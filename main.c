@@ -1,3 +1,4 @@
+#include "lista.h"
 #include "testing.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -19,6 +20,9 @@ int main(int argc, char *argv[])
         return failure_count() > 0;
     }
 
+    printf("\n~~~ PRUEBAS LISTA ~~~\n");
+    pruebas_lista_alumno();
+
     printf("\n~~~ PRUEBAS CÁTEDRA ~~~\n");
     pruebas_hash_catedra();
 
@@ -0,0 +1,42 @@
+#define _GNU_SOURCE 1
+#include "memoria.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define TAM_LINEA_CACHE 64
+#define TAM_PAGINA_GRANDE ((size_t)2 << 20)
+
+/* mmap y munmap trabajan con páginas enteras: el arreglo ocupa tam
+ * redondeado a páginas. Con páginas grandes se reserva una de más para poder
+ * alinearlo, y se devuelve lo que sobra a cada lado. */
+void *memoria_reservar(size_t tam, bool paginas_grandes){
+    if (tam < TAM_PAGINA_GRANDE){
+        void* arreglo;
+        if (posix_memalign(&arreglo, TAM_LINEA_CACHE, tam ? tam : 1)) return NULL;
+        memset(arreglo, 0, tam);
+        return arreglo;
+    }
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    size_t ocupado = (tam + pagina - 1) / pagina * pagina;
+    size_t extra = paginas_grandes ? TAM_PAGINA_GRANDE : 0;
+    char* region = mmap(NULL, ocupado + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) return NULL;
+    if (!paginas_grandes) return region;
+
+    char* arreglo = (char*)(((uintptr_t)region + TAM_PAGINA_GRANDE - 1) & ~(uintptr_t)(TAM_PAGINA_GRANDE - 1));
+    if (arreglo > region) munmap(region, (size_t)(arreglo - region));
+    if (region + extra > arreglo) munmap(arreglo + ocupado, (size_t)(region + extra - arreglo));
+#ifdef MADV_HUGEPAGE
+    madvise(arreglo, ocupado, MADV_HUGEPAGE);
+#endif
+    return arreglo;
+}
+
+void memoria_liberar(void *arreglo, size_t tam){
+    if (!arreglo) return;
+    if (tam < TAM_PAGINA_GRANDE) free(arreglo);
+    else munmap(arreglo, tam);
+}
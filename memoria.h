@@ -0,0 +1,24 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Arreglos grandes para las tablas de hash: se piden alineados a línea de
+ * caché y en cero. Los de al menos una página grande (2 MiB) se piden con
+ * mmap, así se devuelven enteros al sistema al liberarlos, y con
+ * paginas_grandes se alinean a página grande y se le pide al kernel
+ * respaldarlos con páginas grandes transparentes (madvise con
+ * MADV_HUGEPAGE). Con ellas una búsqueda al azar en un arreglo de varios GB
+ * casi no falla en la TLB. Si el kernel no las tiene habilitadas, el arreglo
+ * se usa igual con páginas comunes. */
+
+/* Devuelve un arreglo de tam bytes en cero, o NULL si no hubo memoria.
+ */
+void *memoria_reservar(size_t tam, bool paginas_grandes);
+
+/* Libera un arreglo de memoria_reservar, de tamaño tam.
+ */
+void memoria_liberar(void *arreglo, size_t tam);
+
+#endif // MEMORIA_H
@@ -0,0 +1,19 @@
+#ifndef MEZCLA_H
+#define MEZCLA_H
+
+#include <stdint.h>
+
+/* Mezcla los bits del hash de una clave, ya que los de hash_calcular no
+ * están bien distribuidos, con el finalizador de MurmurHash3. La usan las
+ * tablas que eligen la posición o el filtro con los bits bajos del hash.
+ */
+static inline uint64_t mezclar(uint64_t x){
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+#endif // MEZCLA_H